@@ -0,0 +1,230 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+// Opt-in: build with DOMINO_ALLOCATION_TRACKING set to 1 and expand
+// DOMINO_ALLOCATION_HOOKS in exactly one translation unit of the program (not the
+// MFC application, whose debug heap has its own operator new). Without it the
+// scope macros compile to nothing.
+#ifndef DOMINO_ALLOCATION_TRACKING
+#define DOMINO_ALLOCATION_TRACKING 0
+#endif
+
+#ifdef _MSC_VER
+#define DOMINO_NOINLINE __declspec(noinline)
+#else
+#define DOMINO_NOINLINE __attribute__((noinline))
+#endif
+
+// Allocations made while one kind of engine operation was in flight. One counter
+// exists per ALLOCATION_SCOPE site; all of them can be listed with forEach().
+class AllocationCounter {
+public:
+    const char* const name;
+    const bool zeroAllocation;          // the operation must never allocate
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> violations;   // allocations in a zero-allocation operation
+    AllocationCounter* next;
+
+    AllocationCounter(const char* operation, bool mustNotAllocate);
+
+    AllocationCounter(const AllocationCounter&) = delete;
+    AllocationCounter& operator=(const AllocationCounter&) = delete;
+};
+
+class AllocationTracker {
+public:
+    // Called by the replacement operator new for every allocation
+    static void noteAllocation(size_t size) {
+        AllocationCounter* counter = current();
+        if (!counter) return;
+
+        counter->allocations.fetch_add(1, std::memory_order_relaxed);
+        counter->bytes.fetch_add(size, std::memory_order_relaxed);
+        if (counter->zeroAllocation) {
+            counter->violations.fetch_add(1, std::memory_order_relaxed);
+            if (strictFlag().load(std::memory_order_relaxed)) {
+                // Nothing here may allocate: we are inside operator new
+                std::fputs("Allocation inside zero-allocation operation: ", stderr);
+                std::fputs(counter->name, stderr);
+                std::fputs("\n", stderr);
+                std::abort();
+            }
+        }
+    }
+
+    // Test mode: abort on the first allocation inside a zero-allocation operation
+    static void setStrict(bool strict) { strictFlag().store(strict, std::memory_order_relaxed); }
+    static bool isStrict() { return strictFlag().load(std::memory_order_relaxed); }
+
+    static bool enabled() { return DOMINO_ALLOCATION_TRACKING != 0; }
+
+    // What the replacement operator delete frees with; see DOMINO_ALLOCATION_HOOKS
+    static DOMINO_NOINLINE void release(void* block) { std::free(block); }
+
+    // Storage for the align_val_t overloads; the CRT needs its own free for it
+    static void* allocateAligned(size_t size, size_t alignment) {
+        if (size == 0) size = 1;
+#ifdef _MSC_VER
+        return _aligned_malloc(size, alignment);
+#else
+        void* block = nullptr;
+        return posix_memalign(&block, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) == 0 ? block : nullptr;
+#endif
+    }
+
+    static DOMINO_NOINLINE void freeAligned(void* block) {
+#ifdef _MSC_VER
+        _aligned_free(block);
+#else
+        std::free(block);
+#endif
+    }
+
+    template <typename Visit>
+    static void forEach(Visit visit) {
+        for (AllocationCounter* counter = head().load(std::memory_order_acquire); counter; counter = counter->next) {
+            visit(*counter);
+        }
+    }
+
+    static uint64_t totalViolations() {
+        uint64_t total = 0;
+        forEach([&](const AllocationCounter& counter) { total += counter.violations.load(std::memory_order_relaxed); });
+        return total;
+    }
+
+    static void reset() {
+        forEach([](AllocationCounter& counter) {
+            counter.calls.store(0, std::memory_order_relaxed);
+            counter.allocations.store(0, std::memory_order_relaxed);
+            counter.bytes.store(0, std::memory_order_relaxed);
+            counter.violations.store(0, std::memory_order_relaxed);
+        });
+    }
+
+    static void registerCounter(AllocationCounter* counter) {
+        AllocationCounter* first = head().load(std::memory_order_relaxed);
+        do {
+            counter->next = first;
+        } while (!head().compare_exchange_weak(first, counter, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // The innermost operation in flight on this thread
+    static AllocationCounter*& current() {
+        static thread_local AllocationCounter* counter = nullptr;
+        return counter;
+    }
+
+private:
+    static std::atomic<AllocationCounter*>& head() {
+        static std::atomic<AllocationCounter*> first(nullptr);
+        return first;
+    }
+
+    static std::atomic<bool>& strictFlag() {
+        static std::atomic<bool> strict(false);
+        return strict;
+    }
+};
+
+inline AllocationCounter::AllocationCounter(const char* operation, bool mustNotAllocate)
+    : name(operation), zeroAllocation(mustNotAllocate), calls(0), allocations(0), bytes(0), violations(0),
+      next(nullptr) {
+    AllocationTracker::registerCounter(this);
+}
+
+// Attributes the allocations of the enclosing scope to a counter; scopes nest
+class AllocationScope {
+private:
+    AllocationCounter* previous;
+
+public:
+    explicit AllocationScope(AllocationCounter& counter) : previous(AllocationTracker::current()) {
+        counter.calls.fetch_add(1, std::memory_order_relaxed);
+        AllocationTracker::current() = &counter;
+    }
+
+    ~AllocationScope() { AllocationTracker::current() = previous; }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+};
+
+#if DOMINO_ALLOCATION_TRACKING
+#define ALLOCATION_SCOPE_JOIN2(a, b) a##b
+#define ALLOCATION_SCOPE_JOIN(a, b) ALLOCATION_SCOPE_JOIN2(a, b)
+#define ALLOCATION_SCOPE_AS(name, zero) \
+    static AllocationCounter ALLOCATION_SCOPE_JOIN(allocationCounter, __LINE__)(name, zero); \
+    AllocationScope ALLOCATION_SCOPE_JOIN(allocationScope, __LINE__)(ALLOCATION_SCOPE_JOIN(allocationCounter, __LINE__))
+#define ALLOCATION_SCOPE(name) ALLOCATION_SCOPE_AS(name, false)
+#define ZERO_ALLOCATION_SCOPE(name) ALLOCATION_SCOPE_AS(name, true)
+#else
+#define ALLOCATION_SCOPE(name) ((void)0)
+#define ZERO_ALLOCATION_SCOPE(name) ((void)0)
+#endif
+
+// C++17 sends over-aligned types to the align_val_t overloads; without them those
+// allocations would bypass the counters
+#ifdef __cpp_aligned_new
+#define DOMINO_ALIGNED_ALLOCATION_HOOKS \
+    void* operator new(std::size_t size, std::align_val_t alignment) { \
+        AllocationTracker::noteAllocation(size); \
+        if (void* block = AllocationTracker::allocateAligned(size, static_cast<std::size_t>(alignment))) return block; \
+        throw std::bad_alloc(); \
+    } \
+    void* operator new[](std::size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); } \
+    void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { \
+        AllocationTracker::noteAllocation(size); \
+        return AllocationTracker::allocateAligned(size, static_cast<std::size_t>(alignment)); \
+    } \
+    void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept { \
+        return ::operator new(size, alignment, tag); \
+    } \
+    void operator delete(void* block, std::align_val_t) noexcept { AllocationTracker::freeAligned(block); } \
+    void operator delete[](void* block, std::align_val_t) noexcept { AllocationTracker::freeAligned(block); } \
+    void operator delete(void* block, std::size_t, std::align_val_t) noexcept { AllocationTracker::freeAligned(block); } \
+    void operator delete[](void* block, std::size_t, std::align_val_t) noexcept { AllocationTracker::freeAligned(block); } \
+    void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept { \
+        AllocationTracker::freeAligned(block); \
+    } \
+    void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept { \
+        AllocationTracker::freeAligned(block); \
+    }
+#else
+#define DOMINO_ALIGNED_ALLOCATION_HOOKS
+#endif
+
+// Replacement global allocation functions that report to AllocationTracker.
+// Every delete frees through AllocationTracker::release, which is never inlined:
+// GCC would otherwise inline a delete into its caller, see std::free applied to
+// memory from operator new and warn (-Wmismatched-new-delete), although this
+// operator new is malloc.
+#define DOMINO_ALLOCATION_HOOKS \
+    void* operator new(std::size_t size) { \
+        AllocationTracker::noteAllocation(size); \
+        if (void* block = std::malloc(size ? size : 1)) return block; \
+        throw std::bad_alloc(); \
+    } \
+    void* operator new[](std::size_t size) { return ::operator new(size); } \
+    void* operator new(std::size_t size, const std::nothrow_t&) noexcept { \
+        AllocationTracker::noteAllocation(size); \
+        return std::malloc(size ? size : 1); \
+    } \
+    void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return ::operator new(size, tag); } \
+    void operator delete(void* block) noexcept { AllocationTracker::release(block); } \
+    void operator delete[](void* block) noexcept { AllocationTracker::release(block); } \
+    void operator delete(void* block, std::size_t) noexcept { AllocationTracker::release(block); } \
+    void operator delete[](void* block, std::size_t) noexcept { AllocationTracker::release(block); } \
+    void operator delete(void* block, const std::nothrow_t&) noexcept { AllocationTracker::release(block); } \
+    void operator delete[](void* block, const std::nothrow_t&) noexcept { AllocationTracker::release(block); } \
+    DOMINO_ALIGNED_ALLOCATION_HOOKS
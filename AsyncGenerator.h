@@ -0,0 +1,256 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include "GameGrid.h"
+#include "CancellationToken.h"
+#include "TraceRecorder.h"
+
+// Where completion callbacks run. The view posts them to its window's message
+// queue so they execute on the UI thread; headless callers and tests use
+// QueuedCompletions and drain it themselves.
+class CompletionQueue {
+public:
+    virtual ~CompletionQueue() {}
+    virtual void post(std::function<void()> task) = 0;
+};
+
+// Collects posted completions until the owner drains them on its own thread
+class QueuedCompletions : public CompletionQueue {
+private:
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+
+public:
+    void post(std::function<void()> task) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+
+    // Runs everything posted so far; returns how many tasks ran
+    int drain() {
+        std::deque<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.swap(tasks);
+        }
+        for (auto& task : ready) {
+            task();
+        }
+        return static_cast<int>(ready.size());
+    }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tasks.size();
+    }
+};
+
+struct GenerationRequest {
+    int gridSize;
+    bool extendedSet;
+    Difficulty difficulty;
+    int budgetMs;
+    uint64_t seed;              // a fresh one unless the caller wants a particular puzzle
+
+    GenerationRequest(int size = 8, bool extended = false, Difficulty level = Difficulty::EASY,
+        int budget = 1000)
+        : gridSize(size), extendedSet(extended), difficulty(level), budgetMs(budget),
+        seed(DominoGame::makeSeed()) {}
+};
+
+struct GenerationOutcome {
+    GenerationResult result;
+    GeneratedPuzzle puzzle;     // valid when result.success
+    std::string error;          // why generation threw; empty otherwise
+};
+
+// Future-like view of one queued generation
+class GenerationHandle {
+public:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable done;
+        bool ready;
+        GenerationOutcome outcome;
+        GenerationProgress progress;
+        CancellationToken cancel;
+
+        State() : ready(false), cancel(CancellationToken::create()) {}
+    };
+
+private:
+    std::shared_ptr<State> state;
+
+public:
+    GenerationHandle() {}
+    explicit GenerationHandle(std::shared_ptr<State> s) : state(std::move(s)) {}
+
+    bool isValid() const { return state != nullptr; }
+
+    bool isReady() const {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->ready;
+    }
+
+    // Waits up to the timeout; true once the outcome is available
+    bool waitFor(int timeoutMs) const {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        return state->done.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return state->ready; });
+    }
+
+    // Blocks until the generation has finished
+    const GenerationOutcome& get() const {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [this] { return state->ready; });
+        return state->outcome;
+    }
+
+    void cancel() const { state->cancel.cancel(); }
+
+    int attempts() const { return state->progress.attempts.load(); }
+    uint64_t nodes() const { return state->progress.nodes.load(); }
+};
+
+// Runs generateNewGame on a dedicated pool of worker threads. Each job gets its
+// own DominoGame, so workers never touch the caller's game; the caller installs
+// the finished puzzle with DominoGame::installPuzzle on its own thread.
+class AsyncGenerator {
+public:
+    using CompletionFunction = std::function<void(const GenerationOutcome&)>;
+
+private:
+    struct Job {
+        GenerationRequest request;
+        std::shared_ptr<GenerationHandle::State> state;
+        CompletionQueue* queue;
+        CompletionFunction onComplete;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::vector<std::shared_ptr<GenerationHandle::State>> running;
+    bool stopping;
+    std::vector<std::thread> workers;
+
+public:
+    explicit AsyncGenerator(int workerCount = 0) : stopping(false) {
+        if (workerCount <= 0) {
+            int cores = static_cast<int>(std::thread::hardware_concurrency());
+            workerCount = cores > 2 ? cores - 1 : 1;
+        }
+        for (int i = 0; i < workerCount; ++i) {
+            workers.emplace_back(&AsyncGenerator::workerLoop, this);
+        }
+    }
+
+    // Cancels queued and running jobs alike, so shutdown waits for the next cancellation
+    // check of each worker rather than for whole generation budgets
+    ~AsyncGenerator() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            for (auto& job : jobs) {
+                job.state->cancel.cancel();
+            }
+            for (auto& state : running) {
+                state->cancel.cancel();
+            }
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+
+    // Queues a generation. When onComplete is given it is posted to `queue` once the
+    // puzzle is ready, or called on the worker thread if no queue is given.
+    GenerationHandle submit(const GenerationRequest& request, CompletionQueue* queue = nullptr,
+        CompletionFunction onComplete = nullptr) {
+        auto state = std::make_shared<GenerationHandle::State>();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(Job{ request, state, queue, std::move(onComplete) });
+        }
+        wake.notify_one();
+        return GenerationHandle(state);
+    }
+
+    size_t workerCount() const { return workers.size(); }
+
+private:
+    void workerLoop() {
+        TraceRecorder::instance().setThreadName("Generator worker");
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                running.push_back(job.state);
+            }
+
+            GenerationOutcome outcome = run(job);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running.erase(std::find(running.begin(), running.end(), job.state));
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(job.state->mutex);
+                job.state->outcome = outcome;
+                job.state->ready = true;
+            }
+            job.state->done.notify_all();
+
+            if (job.onComplete) {
+                if (job.queue) {
+                    std::shared_ptr<GenerationHandle::State> state = job.state;
+                    CompletionFunction onComplete = job.onComplete;
+                    job.queue->post([state, onComplete] { onComplete(state->outcome); });
+                }
+                else {
+                    job.onComplete(outcome);
+                }
+            }
+        }
+    }
+
+    static GenerationOutcome run(const Job& job) {
+        GenerationOutcome outcome;
+        if (job.state->cancel.isCancelled()) {
+            outcome.result.cancelled = true;
+            return outcome;
+        }
+
+        try {
+            DominoGame game(job.request.extendedSet, job.request.gridSize);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(job.request.budgetMs);
+            outcome.result = game.generateNewGame(job.request.difficulty, job.request.seed, deadline, job.state->cancel,
+                &job.state->progress);
+            if (outcome.result.success) {
+                outcome.puzzle = game.exportPuzzle();
+            }
+        }
+        catch (const std::exception& e) {
+            outcome.result = GenerationResult();
+            outcome.error = e.what();
+        }
+        return outcome;
+    }
+};
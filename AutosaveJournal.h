@@ -0,0 +1,288 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "GameGrid.h"
+#include "MappedFile.h"
+#include "LittleEndian.h"
+#include "Crc32.h"
+
+// Autosave as a snapshot plus an append-only journal of moves.
+//
+// The snapshot is an ordinary save (DominoGame::saveGame format) at `savePath`;
+// the journal lives next to it at `savePath + ".journal"`. Every player action
+// appends one 8-byte entry; the file is flushed to the OS at once and synced to
+// disk at most every `syncIntervalMs` (and on flush() or destruction). After
+// `compactEvery` entries, or when the game is replaced wholesale, a fresh
+// snapshot is written and the journal restarts empty.
+//
+// The journal header names the snapshot it extends by the CRC of that snapshot,
+// so a journal left over from an older snapshot is never replayed onto a newer
+// one. On startup restore() loads the snapshot and replays entries up to the
+// first torn or unreadable one, then cuts the journal there.
+//
+// Single-threaded: use it on the thread that owns the game.
+class AutosaveJournal {
+public:
+    static const int DEFAULT_SYNC_INTERVAL_MS = 1000;
+    static const int DEFAULT_COMPACT_EVERY = 256;
+    static const int ENTRY_SIZE = 8;
+
+private:
+    static const uint32_t MAGIC = 0x4A5A5044;     // "DPZJ"
+    static const int FORMAT_VERSION = 1;
+    static const int HEADER_SIZE = 16;
+    static const int SAVE_CRC_OFFSET = 12;        // where DominoGame keeps its payload CRC
+    static const uint8_t NO_CELL = 0xFF;
+
+    std::string savePath;
+    std::string journalPath;
+    int syncIntervalMs;
+    int compactEvery;
+
+    DominoGame* game;
+    FILE* journal;
+    int entriesSinceSnapshot;
+    bool restored;      // the game matches snapshot + journal on disk
+    bool unsynced;
+    std::chrono::steady_clock::time_point lastSync;
+
+    uint64_t bytesAppended;
+    int snapshots;
+    int syncs;
+
+public:
+    explicit AutosaveJournal(const std::string& path, int syncInterval = DEFAULT_SYNC_INTERVAL_MS,
+        int snapshotEvery = DEFAULT_COMPACT_EVERY)
+        : savePath(path), journalPath(path + ".journal"), syncIntervalMs(syncInterval),
+          compactEvery(snapshotEvery > 0 ? snapshotEvery : DEFAULT_COMPACT_EVERY),
+          game(nullptr), journal(nullptr), entriesSinceSnapshot(0), restored(false), unsynced(false),
+          lastSync(std::chrono::steady_clock::now()), bytesAppended(0), snapshots(0), syncs(0) {}
+
+    ~AutosaveJournal() {
+        detach();
+    }
+
+    AutosaveJournal(const AutosaveJournal&) = delete;
+    AutosaveJournal& operator=(const AutosaveJournal&) = delete;
+
+    // Loads the snapshot and replays the journal on top of it; call before attach().
+    // Returns false if there is no usable snapshot; the game is then left as it was.
+    // Snapshots are only ever written by compact(), so they load without the rule replay.
+    bool restore(DominoGame& target) {
+        detach();
+        restored = false;
+        if (!target.loadGame(savePath, LoadMode::TRUSTED)) {
+            return false;
+        }
+
+        uint32_t snapshotCrc = 0;
+        if (!readSnapshotCrc(snapshotCrc)) {
+            return true;
+        }
+
+        size_t good = 0;
+        size_t length = 0;
+        {
+            MappedFile view;
+            if (!view.open(journalPath) || view.size() < static_cast<size_t>(HEADER_SIZE) ||
+                !headerMatches(view.data(), snapshotCrc)) {
+                return true;
+            }
+
+            length = view.size();
+            size_t entries = (length - HEADER_SIZE) / ENTRY_SIZE;
+            const uint8_t* entry = view.data() + HEADER_SIZE;
+            for (; good < entries; ++good, entry += ENTRY_SIZE) {
+                MoveRecord record;
+                if (!decode(entry, record) || !target.applyMove(record)) break;
+            }
+        }
+
+        size_t intact = HEADER_SIZE + good * ENTRY_SIZE;
+        if (intact == length || PlatformFile::truncate(journalPath, intact)) {
+            entriesSinceSnapshot = static_cast<int>(good);
+            restored = true;
+        }
+        return true;
+    }
+
+    // Starts journaling the game's moves. Writes a snapshot unless restore() just
+    // matched the files on disk to the game's state.
+    bool attach(DominoGame& target) {
+        bool resume = restored;
+        detach();
+        game = &target;
+        game->setMoveRecordedCallback([this](const MoveRecord& record) { onMove(record); });
+
+        uint32_t snapshotCrc = 0;
+        if (resume && readSnapshotCrc(snapshotCrc) && journalMatches(snapshotCrc)) {
+            journal = PlatformFile::openStream(journalPath, "ab");
+            if (journal) return true;
+        }
+        return compact();
+    }
+
+    void detach() {
+        if (game) {
+            game->setMoveRecordedCallback(nullptr);
+            game = nullptr;
+        }
+        closeJournal();
+        restored = false;
+    }
+
+    // Writes the current state as the new snapshot and starts an empty journal for it
+    bool compact() {
+        if (!game) return false;
+        closeJournal();
+
+        std::vector<uint8_t> snapshot = game->serialize();
+        if (!writeDurably(savePath, snapshot.data(), snapshot.size())) {
+            return false;
+        }
+
+        uint8_t header[HEADER_SIZE];
+        writeHeader(header, LittleEndian::get32(snapshot.data() + SAVE_CRC_OFFSET));
+        if (!writeDurably(journalPath, header, HEADER_SIZE)) {
+            return false;
+        }
+
+        journal = PlatformFile::openStream(journalPath, "ab");
+        entriesSinceSnapshot = 0;
+        unsynced = false;
+        lastSync = std::chrono::steady_clock::now();
+        ++snapshots;
+        return journal != nullptr;
+    }
+
+    // Syncs appended entries to disk now; call from an idle handler or on shutdown
+    void flush() {
+        if (journal && unsynced) {
+            PlatformFile::sync(journal);
+            unsynced = false;
+            lastSync = std::chrono::steady_clock::now();
+            ++syncs;
+        }
+    }
+
+    int getEntriesSinceSnapshot() const { return entriesSinceSnapshot; }
+    uint64_t getBytesAppended() const { return bytesAppended; }
+    int getSnapshotCount() const { return snapshots; }
+    int getSyncCount() const { return syncs; }
+
+private:
+    void onMove(const MoveRecord& record) {
+        if (record.kind == MoveRecord::RESET || entriesSinceSnapshot + 1 >= compactEvery || !journal) {
+            compact();
+            return;
+        }
+
+        uint8_t entry[ENTRY_SIZE];
+        encode(record, entry);
+        if (std::fwrite(entry, 1, ENTRY_SIZE, journal) != ENTRY_SIZE || std::fflush(journal) != 0) {
+            compact();
+            return;
+        }
+        ++entriesSinceSnapshot;
+        bytesAppended += ENTRY_SIZE;
+        unsynced = true;
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSync >= std::chrono::milliseconds(syncIntervalMs)) {
+            flush();
+        }
+    }
+
+    void closeJournal() {
+        if (journal) {
+            flush();
+            std::fclose(journal);
+            journal = nullptr;
+        }
+    }
+
+    // Entry: kind | vertical << 3, value nibbles, from row/col, to row/col, 16-bit check
+    static void encode(const MoveRecord& record, uint8_t* entry) {
+        int vertical = record.orientation == Orientation::VERTICAL ? 1 : 0;
+        entry[0] = static_cast<uint8_t>(record.kind | (vertical << 3));
+        entry[1] = static_cast<uint8_t>(((record.value1 & 0x0F) << 4) | (record.value2 & 0x0F));
+        entry[2] = cellByte(record.from.row);
+        entry[3] = cellByte(record.from.col);
+        entry[4] = cellByte(record.to.row);
+        entry[5] = cellByte(record.to.col);
+        LittleEndian::put16(entry + 6, static_cast<uint16_t>(Crc32::compute(entry, 6)));
+    }
+
+    static bool decode(const uint8_t* entry, MoveRecord& record) {
+        if (LittleEndian::get16(entry + 6) != static_cast<uint16_t>(Crc32::compute(entry, 6))) {
+            return false;
+        }
+        int kind = entry[0] & 0x07;
+        if (kind > MoveRecord::HINT) {
+            return false;
+        }
+        record.kind = static_cast<MoveRecord::Kind>(kind);
+        record.orientation = (entry[0] >> 3) & 1 ? Orientation::VERTICAL : Orientation::HORIZONTAL;
+        record.value1 = entry[1] >> 4;
+        record.value2 = entry[1] & 0x0F;
+        record.from = Position(cellValue(entry[2]), cellValue(entry[3]));
+        record.to = Position(cellValue(entry[4]), cellValue(entry[5]));
+        return true;
+    }
+
+    static uint8_t cellByte(int coordinate) {
+        return coordinate < 0 ? NO_CELL : static_cast<uint8_t>(coordinate);
+    }
+
+    static int cellValue(uint8_t stored) {
+        return stored == NO_CELL ? -1 : stored;
+    }
+
+    static void writeHeader(uint8_t* header, uint32_t snapshotCrc) {
+        LittleEndian::put32(header, MAGIC);
+        LittleEndian::put16(header + 4, FORMAT_VERSION);
+        LittleEndian::put16(header + 6, 0);
+        LittleEndian::put32(header + 8, snapshotCrc);
+        LittleEndian::put32(header + 12, Crc32::compute(header, 12));
+    }
+
+    static bool headerMatches(const uint8_t* header, uint32_t snapshotCrc) {
+        uint8_t expected[HEADER_SIZE];
+        writeHeader(expected, snapshotCrc);
+        return std::equal(header, header + HEADER_SIZE, expected);
+    }
+
+    bool readSnapshotCrc(uint32_t& crc) const {
+        uint8_t header[SAVE_CRC_OFFSET + 4];
+        FILE* file = PlatformFile::openStream(savePath, "rb");
+        if (!file) return false;
+        bool ok = std::fread(header, 1, sizeof(header), file) == sizeof(header);
+        std::fclose(file);
+        if (ok) crc = LittleEndian::get32(header + SAVE_CRC_OFFSET);
+        return ok;
+    }
+
+    bool journalMatches(uint32_t snapshotCrc) const {
+        uint8_t header[HEADER_SIZE];
+        FILE* file = PlatformFile::openStream(journalPath, "rb");
+        if (!file) return false;
+        bool ok = std::fread(header, 1, HEADER_SIZE, file) == HEADER_SIZE && headerMatches(header, snapshotCrc);
+        std::fclose(file);
+        return ok;
+    }
+
+    // Writes to a temporary file, syncs it and renames it over the target
+    static bool writeDurably(const std::string& path, const uint8_t* data, size_t length) {
+        std::string temporary = path + ".tmp";
+        FILE* file = PlatformFile::openStream(temporary, "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(data, 1, length, file) == length;
+        ok = PlatformFile::sync(file) && ok;
+        std::fclose(file);
+        return ok && PlatformFile::replace(temporary, path);
+    }
+};
@@ -0,0 +1,430 @@
+// Deterministic performance regression harness for the game engine.
+//
+//   g++ -std=c++14 -O2 -I.. RegressionHarness.cpp -o regression-harness -pthread
+//   cl /std:c++14 /O2 /EHsc /I.. RegressionHarness.cpp
+//
+// Runs a fixed corpus through the engine and compares each case with the
+// checked-in baseline (RegressionBaseline.txt next to this file):
+//   solve-N   PuzzleSolver::solve on puzzle N from an empty board
+//   hint-N    PuzzleSolver::findHint on puzzle N with a wrong piece placed first,
+//             which forces the bisection over placement prefixes
+//   replay-N  a move log for puzzle N applied to a DominoGame with applyMove,
+//             asking for a solver hint after every move
+//   generate-N  DominoGame::generateNewGame on the N-th entry of GENERATE_CORPUS;
+//             the small boards are there because their search backtracks
+//
+// Puzzles and move logs are built from their seed with std::mt19937, whose output the
+// standard fixes, so every platform runs the same corpus. Search node counts do not
+// depend on the machine: any case that explores more nodes than its baseline fails.
+// Wall time (median of --repeat runs) fails only beyond --time-tolerance percent plus
+// --time-slack-us, so sub-millisecond cases do not fail on scheduler noise.
+//
+// Options: --baseline file, --record (rewrite the baseline from this run),
+//          --node-tolerance PCT (default 0), --time-tolerance PCT (default 50, negative
+//          disables), --time-slack-us N (default 2000), --repeat N (default 5)
+// Exit code: 0 pass, 1 regression, 2 usage error or missing baseline.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../GameGrid.h"
+#include "../PuzzleSolver.h"
+
+std::atomic<int> Domino::nextId(0);
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int SOLVER_BUDGET_MS = 60000;     // large enough that no case can time out
+const int SOLVE_CASES = 12;
+const int HINT_CASES = 6;
+const int REPLAY_CASES = 6;
+
+// Shapes and seeds for the generate cases. The first four are large boards, where the
+// search rarely backtracks and the time goes to grading; the rest backtrack thousands
+// of nodes before they find a layout.
+struct GenerateCase {
+    int gridSize;
+    bool extendedSet;
+    Difficulty difficulty;
+    uint64_t seed;
+};
+
+const GenerateCase GENERATE_CORPUS[] = {
+    { 16, false, Difficulty::MEDIUM, 1 },
+    { 20, true, Difficulty::HARD, 2 },
+    { 12, false, Difficulty::EASY, 3 },
+    { 16, true, Difficulty::MEDIUM, 4 },
+    { 5, false, Difficulty::MEDIUM, 1 },
+    { 5, false, Difficulty::HARD, 4 },
+    { 6, false, Difficulty::EASY, 8 },
+    { 7, false, Difficulty::MEDIUM, 11 },
+    { 8, false, Difficulty::HARD, 8 },
+    { 5, true, Difficulty::MEDIUM, 2 },
+    { 6, true, Difficulty::HARD, 11 },
+};
+const int GENERATE_CASES = static_cast<int>(sizeof(GENERATE_CORPUS) / sizeof(GENERATE_CORPUS[0]));
+
+struct HarnessOptions {
+    std::string baselinePath;
+    bool record;
+    double nodeTolerance;       // percent
+    double timeTolerance;       // percent; negative disables the time check
+    double timeSlackMicros;     // added to every time limit
+    int repeat;
+
+    HarnessOptions() : baselinePath("RegressionBaseline.txt"), record(false), nodeTolerance(0.0),
+        timeTolerance(50.0), timeSlackMicros(2000.0), repeat(5) {}
+};
+
+struct Measurement {
+    uint64_t nodes;
+    double wallMicros;
+    bool valid;                 // the case ran to the expected outcome
+
+    Measurement() : nodes(0), wallMicros(0.0), valid(true) {}
+};
+
+struct CorpusPuzzle {
+    CompactBoard puzzle;        // pieces unplaced, clues set
+    CompactBoard solution;
+};
+
+// Draws in [0, bound) straight from the engine, so the sequence is the same everywhere
+int draw(std::mt19937& rng, int bound) {
+    return static_cast<int>(rng() % static_cast<uint32_t>(bound));
+}
+
+// Lays distinct-sum, non-double pieces out under the player rules, then shows
+// the adjacent sums of some empty cells as clues
+CorpusPuzzle buildPuzzle(int seed) {
+    std::mt19937 rng(static_cast<uint32_t>(seed));
+    int size = 6 + seed % 4;
+    int wanted = 6 + seed % 5;
+
+    std::vector<std::pair<int, int>> candidates;
+    for (int v1 = 0; v1 <= 9; ++v1) {
+        for (int v2 = v1 + 1; v2 <= 9; ++v2) {
+            candidates.emplace_back(v1, v2);
+        }
+    }
+    for (int i = static_cast<int>(candidates.size()) - 1; i > 0; --i) {
+        std::swap(candidates[i], candidates[draw(rng, i + 1)]);
+    }
+
+    CorpusPuzzle result;
+    result.solution.reset(size);
+    for (const auto& candidate : candidates) {
+        if (result.solution.pieceCount() >= wanted) break;
+        int sum = candidate.first + candidate.second;
+        if ((result.solution.usedSums() >> sum) & 1u) continue;
+
+        CompactBoard trial = result.solution;
+        int index = trial.addPiece(candidate.first, candidate.second);
+        for (int attempt = 0; attempt < 200; ++attempt) {
+            if (trial.place(index, draw(rng, size), draw(rng, size), draw(rng, 2))) {
+                result.solution = trial;
+                break;
+            }
+        }
+    }
+
+    std::vector<int> emptyCells;
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            if (!result.solution.isOccupied(row, col) && result.solution.adjacentSum(row, col) > 0) {
+                emptyCells.push_back(row * size + col);
+            }
+        }
+    }
+    for (int i = static_cast<int>(emptyCells.size()) - 1; i > 0; --i) {
+        std::swap(emptyCells[i], emptyCells[draw(rng, i + 1)]);
+    }
+
+    result.puzzle.reset(size);
+    for (int i = 0; i < result.solution.pieceCount(); ++i) {
+        result.puzzle.addPiece(result.solution.piece(i).value1, result.solution.piece(i).value2);
+    }
+    int clueCount = std::min(static_cast<int>(emptyCells.size()), size / 2);
+    for (int i = 0; i < clueCount; ++i) {
+        int row = emptyCells[i] / size, col = emptyCells[i] % size;
+        int clue = result.solution.adjacentSum(row, col);
+        result.puzzle.setClue(row, col, clue);
+        result.solution.setClue(row, col, clue);
+    }
+    return result;
+}
+
+// Runs work() once untimed, to warm caches and the allocator, then `repeat` times more;
+// the node count must agree every time and the wall time is the median timed run
+template <typename Work>
+Measurement measure(int repeat, Work work) {
+    Measurement result;
+    result.valid = work(result.nodes);
+    std::vector<double> times;
+    for (int run = 0; run < repeat && result.valid; ++run) {
+        uint64_t nodes = 0;
+        Clock::time_point start = Clock::now();
+        bool reached = work(nodes);
+        times.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        result.valid = reached && nodes == result.nodes;
+    }
+    if (times.empty()) return result;
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    result.wallMicros = times[times.size() / 2];
+    return result;
+}
+
+bool runSolve(int seed, uint64_t& nodes) {
+    CorpusPuzzle corpus = buildPuzzle(seed);
+    PuzzleSolver solver(SOLVER_BUDGET_MS);
+    SolveResult result = solver.solve(corpus.puzzle);
+    nodes = solver.getNodeCount();
+    return result.status == SolveStatus::SOLVED;
+}
+
+bool runHint(int seed, uint64_t& nodes) {
+    CorpusPuzzle corpus = buildPuzzle(seed);
+    std::mt19937 rng(static_cast<uint32_t>(seed) * 7919u);
+    CompactBoard board = corpus.puzzle;
+    int size = board.size();
+
+    // First a legal placement of piece 0 that is not where the solution has it
+    const CompactPiece& target = corpus.solution.piece(0);
+    bool placedWrong = false;
+    for (int attempt = 0; attempt < 500 && !placedWrong; ++attempt) {
+        int row = draw(rng, size), col = draw(rng, size), vertical = draw(rng, 2);
+        if (row == target.row && col == target.col && vertical == target.vertical) continue;
+        placedWrong = board.place(0, row, col, vertical);
+    }
+    // Then the solution's own placements wherever they still fit
+    for (int i = 1; i < board.pieceCount(); ++i) {
+        const CompactPiece& p = corpus.solution.piece(i);
+        board.place(i, p.row, p.col, p.vertical);
+    }
+
+    PuzzleSolver solver(SOLVER_BUDGET_MS);
+    SolverHint hint = solver.findHint(board);
+    nodes = hint.nodes;
+    return placedWrong && hint.status != SolverHint::TIMED_OUT;
+}
+
+bool runReplay(int seed, uint64_t& nodes) {
+    CorpusPuzzle corpus = buildPuzzle(seed);
+    int size = corpus.puzzle.size();
+
+    GeneratedPuzzle puzzle;
+    puzzle.gridSize = size;
+    puzzle.difficulty = Difficulty::MEDIUM;
+    puzzle.clues.assign(size, std::vector<int>(size, 0));
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            puzzle.clues[row][col] = corpus.puzzle.getClue(row, col);
+        }
+    }
+    for (int i = 0; i < corpus.solution.pieceCount(); ++i) {
+        const CompactPiece& p = corpus.solution.piece(i);
+        Domino domino(p.value1, p.value2);
+        domino.place(Position(p.row, p.col), p.vertical ? Orientation::VERTICAL : Orientation::HORIZONTAL);
+        puzzle.solution.push_back(domino);
+    }
+
+    DominoGame game(false, size);
+    game.setHintTimeBudget(SOLVER_BUDGET_MS);
+    game.installPuzzle(puzzle);
+
+    // The log: every solution piece in a seeded order, some of them first tried
+    // somewhere wrong (hinted, then taken back)
+    std::mt19937 rng(static_cast<uint32_t>(seed) * 104729u);
+    std::vector<int> order;
+    for (int i = 0; i < corpus.solution.pieceCount(); ++i) order.push_back(i);
+    for (int i = static_cast<int>(order.size()) - 1; i > 0; --i) {
+        std::swap(order[i], order[draw(rng, i + 1)]);
+    }
+
+    nodes = 0;
+    for (int index : order) {
+        const Domino& piece = puzzle.solution[index];
+        if (draw(rng, 3) == 0) {
+            for (int attempt = 0; attempt < 50; ++attempt) {
+                MoveRecord wrong(MoveRecord::PLACE);
+                wrong.value1 = piece.getValue1();
+                wrong.value2 = piece.getValue2();
+                wrong.to = Position(draw(rng, size), draw(rng, size));
+                wrong.orientation = draw(rng, 2) ? Orientation::VERTICAL : Orientation::HORIZONTAL;
+                if (wrong.to == piece.getPosition() && wrong.orientation == piece.getOrientation()) continue;
+                if (game.applyMove(wrong)) {
+                    nodes += game.getSolverHint().nodes;
+                    MoveRecord undo(MoveRecord::REMOVE);
+                    undo.from = wrong.to;
+                    if (!game.applyMove(undo)) return false;
+                    break;
+                }
+            }
+        }
+
+        MoveRecord place(MoveRecord::PLACE);
+        place.value1 = piece.getValue1();
+        place.value2 = piece.getValue2();
+        place.to = piece.getPosition();
+        place.orientation = piece.getOrientation();
+        if (!game.applyMove(place)) return false;
+        nodes += game.getSolverHint().nodes;
+    }
+    return true;
+}
+
+// The simplified fallback does not search, so a case that falls back has not reached its outcome
+bool runGenerate(const GenerateCase& entry, uint64_t& nodes) {
+    DominoGame game(entry.extendedSet, entry.gridSize);
+    GenerationResult result = game.generateNewGame(entry.difficulty, entry.seed,
+        Clock::now() + std::chrono::milliseconds(SOLVER_BUDGET_MS));
+    nodes = result.nodes;
+    return result.success && !result.timedOut && !result.simplified;
+}
+
+struct Baseline {
+    uint64_t nodes;
+    double wallMicros;
+};
+
+bool readBaseline(const std::string& path, std::map<std::string, Baseline>& baseline) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        Baseline entry;
+        if (fields >> name >> entry.nodes >> entry.wallMicros) {
+            baseline[name] = entry;
+        }
+    }
+    return true;
+}
+
+bool writeBaseline(const std::string& path, const std::vector<std::pair<std::string, Measurement>>& results) {
+    std::ofstream out(path, std::ios::trunc);
+    out << "# Engine regression baseline: case, search nodes, median wall time in microseconds.\n"
+        << "# Regenerate with: regression-harness --record --baseline RegressionBaseline.txt\n";
+    for (const auto& result : results) {
+        out << result.first << " " << result.second.nodes << " "
+            << static_cast<uint64_t>(result.second.wallMicros + 0.5) << "\n";
+    }
+    return out.good();
+}
+
+bool parseOptions(int argc, char** argv, HarnessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record") {
+            options.record = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (arg == "--baseline") options.baselinePath = value;
+        else if (arg == "--node-tolerance") options.nodeTolerance = std::atof(value);
+        else if (arg == "--time-tolerance") options.timeTolerance = std::atof(value);
+        else if (arg == "--time-slack-us") options.timeSlackMicros = std::max(0.0, std::atof(value));
+        else if (arg == "--repeat") options.repeat = std::max(1, std::atoi(value));
+        else return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    HarnessOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: regression-harness [--baseline file] [--record] [--node-tolerance PCT]"
+            " [--time-tolerance PCT] [--time-slack-us N] [--repeat N]\n";
+        return 2;
+    }
+
+    std::vector<std::pair<std::string, Measurement>> results;
+    for (int seed = 1; seed <= SOLVE_CASES; ++seed) {
+        results.emplace_back("solve-" + std::to_string(seed), measure(options.repeat,
+            [seed](uint64_t& nodes) { return runSolve(seed, nodes); }));
+    }
+    for (int seed = 1; seed <= HINT_CASES; ++seed) {
+        results.emplace_back("hint-" + std::to_string(seed), measure(options.repeat,
+            [seed](uint64_t& nodes) { return runHint(seed, nodes); }));
+    }
+    for (int seed = 1; seed <= REPLAY_CASES; ++seed) {
+        results.emplace_back("replay-" + std::to_string(seed), measure(options.repeat,
+            [seed](uint64_t& nodes) { return runReplay(seed, nodes); }));
+    }
+    for (int index = 0; index < GENERATE_CASES; ++index) {
+        const GenerateCase& entry = GENERATE_CORPUS[index];
+        results.emplace_back("generate-" + std::to_string(index + 1), measure(options.repeat,
+            [&entry](uint64_t& nodes) { return runGenerate(entry, nodes); }));
+    }
+
+    for (const auto& result : results) {
+        if (!result.second.valid) {
+            std::cout << result.first << ": did not reach its expected outcome\n";
+            return 1;
+        }
+    }
+
+    if (options.record) {
+        if (!writeBaseline(options.baselinePath, results)) {
+            std::cerr << "cannot write " << options.baselinePath << "\n";
+            return 2;
+        }
+        std::cout << "recorded " << results.size() << " cases to " << options.baselinePath << "\n";
+        return 0;
+    }
+
+    std::map<std::string, Baseline> baseline;
+    if (!readBaseline(options.baselinePath, baseline)) {
+        std::cerr << "cannot read " << options.baselinePath << "; run with --record first\n";
+        return 2;
+    }
+
+    int regressions = 0, improvements = 0;
+    for (const auto& result : results) {
+        const Measurement& now = result.second;
+        auto found = baseline.find(result.first);
+        if (found == baseline.end()) {
+            std::cout << result.first << ": no baseline (nodes " << now.nodes << ")\n";
+            ++regressions;
+            continue;
+        }
+
+        const Baseline& before = found->second;
+        double nodeLimit = before.nodes * (1.0 + options.nodeTolerance / 100.0);
+        double timeLimit = before.wallMicros * (1.0 + options.timeTolerance / 100.0) + options.timeSlackMicros;
+        const char* verdict = "ok";
+        if (now.nodes > nodeLimit) {
+            verdict = "REGRESSION: more nodes";
+            ++regressions;
+        }
+        else if (options.timeTolerance >= 0 && now.wallMicros > timeLimit) {
+            verdict = "REGRESSION: slower";
+            ++regressions;
+        }
+        else if (now.nodes < before.nodes) {
+            verdict = "improved: re-record the baseline";
+            ++improvements;
+        }
+
+        std::printf("%-11s nodes %10llu (baseline %10llu)  time %10.0f us (baseline %10.0f)  %s\n",
+            result.first.c_str(), static_cast<unsigned long long>(now.nodes),
+            static_cast<unsigned long long>(before.nodes), now.wallMicros, before.wallMicros, verdict);
+    }
+
+    std::printf("%d cases, %d regressions, %d improved\n", static_cast<int>(results.size()), regressions, improvements);
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Appends fields of 1 to 32 bits to a byte buffer, least significant bit first
+class BitWriter {
+private:
+    std::vector<uint8_t>& out;
+    uint64_t pending;
+    int pendingBits;
+
+public:
+    explicit BitWriter(std::vector<uint8_t>& buffer) : out(buffer), pending(0), pendingBits(0) {}
+
+    void write(uint32_t value, int bits) {
+        pending |= static_cast<uint64_t>(value & maskOf(bits)) << pendingBits;
+        pendingBits += bits;
+        while (pendingBits >= 8) {
+            out.push_back(static_cast<uint8_t>(pending));
+            pending >>= 8;
+            pendingBits -= 8;
+        }
+    }
+
+    // Pads the last partial byte with zeros
+    void flush() {
+        if (pendingBits > 0) {
+            out.push_back(static_cast<uint8_t>(pending));
+            pending = 0;
+            pendingBits = 0;
+        }
+    }
+
+    static uint32_t maskOf(int bits) {
+        return bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1u;
+    }
+};
+
+// Reads fields written by BitWriter. Reading past the end yields zeros and
+// sets the overrun flag, so decoders check once at the end instead of per field.
+class BitReader {
+private:
+    const uint8_t* data;
+    size_t length;
+    size_t position;    // in bits
+    bool overrun;
+
+public:
+    BitReader(const uint8_t* bytes, size_t byteCount)
+        : data(bytes), length(byteCount * 8), position(0), overrun(false) {}
+
+    uint32_t read(int bits) {
+        if (position + bits > length) {
+            overrun = true;
+            position = length;
+            return 0;
+        }
+        uint32_t value = 0;
+        for (int done = 0; done < bits;) {
+            size_t byte = position >> 3;
+            int offset = static_cast<int>(position & 7);
+            int take = 8 - offset < bits - done ? 8 - offset : bits - done;
+            uint32_t chunk = (data[byte] >> offset) & BitWriter::maskOf(take);
+            value |= chunk << done;
+            done += take;
+            position += take;
+        }
+        return value;
+    }
+
+    bool hasOverrun() const { return overrun; }
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+// Cooperative cancellation flag shared between the thread that starts a job
+// and the thread running it. Copies refer to the same flag; a default
+// constructed token is never cancelled.
+class CancellationToken {
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+
+public:
+    CancellationToken() {}
+
+    static CancellationToken create() {
+        CancellationToken token;
+        token.flag = std::make_shared<std::atomic<bool>>(false);
+        return token;
+    }
+
+    void cancel() const {
+        if (flag) {
+            flag->store(true, std::memory_order_relaxed);
+        }
+    }
+
+    bool isCancelled() const {
+        return flag && flag->load(std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,2 @@
+#include "pch.h"
+#include "ClueSumTables.h"
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Partitions of clue values into distinct piece sums. A clue equals the sum of
+// the distinct pieces around it, at most MAX_NEIGHBOURS of which fit without
+// touching each other, and with unique sums no two of them share a sum. The
+// tables list, for every clue value, each set of sums that adds up to it, so
+// the propagators can test a clue against the sums still available with a
+// handful of mask operations instead of trial placements.
+//
+// Sums are kept as bit masks (bit s = a piece with sum s). Sums 1..MAX_PIECE_SUM
+// cover both createStandardSet (up to 6+6) and createExtendedSet (up to 9+9).
+// A zero-sum piece never changes a clue, so it takes no part in partitions.
+class ClueSumTables {
+public:
+    static const int MAX_PIECE_SUM = 18;
+    static const int MAX_NEIGHBOURS = 4;
+    static const int MAX_CLUE = MAX_PIECE_SUM + (MAX_PIECE_SUM - 1) + (MAX_PIECE_SUM - 2) + (MAX_PIECE_SUM - 3);
+    static const uint32_t ALL_SUMS = ((1u << (MAX_PIECE_SUM + 1)) - 1u) & ~1u;
+
+    static const ClueSumTables& instance() {
+        static const ClueSumTables tables;
+        return tables;
+    }
+
+    // True if every sum in the mask is one the tables know about
+    static bool covers(uint64_t sumsMask) {
+        return (sumsMask & ~uint64_t(ALL_SUMS | 1u)) == 0;
+    }
+
+    // Can `clue` be made from at most `slots` distinct sums taken from `available`?
+    bool feasible(int clue, int slots, uint32_t available) const {
+        if (clue == 0) return true;
+        if (clue < 0 || clue > MAX_CLUE || slots <= 0) return false;
+        const uint32_t* it = begin(clue);
+        const uint32_t* end = this->end(clue, slots);
+        for (; it != end; ++it) {
+            if ((*it & ~available) == 0) return true;
+        }
+        return false;
+    }
+
+    // Sums that appear in at least one feasible partition (`usable`) and in every one (`required`).
+    // Returns false when no partition exists.
+    bool partitionBounds(int clue, int slots, uint32_t available, uint32_t& usable, uint32_t& required) const {
+        usable = 0;
+        required = 0;
+        if (clue == 0) return true;
+        if (clue < 0 || clue > MAX_CLUE || slots <= 0) return false;
+
+        bool any = false;
+        uint32_t all = ALL_SUMS;
+        const uint32_t* it = begin(clue);
+        const uint32_t* end = this->end(clue, slots);
+        for (; it != end; ++it) {
+            if ((*it & ~available) != 0) continue;
+            usable |= *it;
+            all &= *it;
+            any = true;
+        }
+        required = any ? all : 0;
+        return any;
+    }
+
+    // Number of partitions of a clue into at most `slots` sums, ignoring availability
+    int partitionCount(int clue, int slots) const {
+        if (clue < 0 || clue > MAX_CLUE || slots <= 0) return 0;
+        return static_cast<int>(end(clue, slots) - begin(clue));
+    }
+
+private:
+    // Partitions grouped by clue, and within a clue by part count
+    std::vector<uint32_t> partitions;
+    int offsets[MAX_CLUE + 1][MAX_NEIGHBOURS + 2];
+
+    const uint32_t* begin(int clue) const {
+        return partitions.data() + offsets[clue][1];
+    }
+
+    const uint32_t* end(int clue, int slots) const {
+        int parts = slots > MAX_NEIGHBOURS ? MAX_NEIGHBOURS : slots;
+        return partitions.data() + offsets[clue][parts + 1];
+    }
+
+    ClueSumTables() {
+        std::vector<uint32_t> byClue[MAX_CLUE + 1][MAX_NEIGHBOURS + 1];
+        collect(1, 0, 0, 0, byClue);
+
+        for (int clue = 0; clue <= MAX_CLUE; ++clue) {
+            offsets[clue][0] = static_cast<int>(partitions.size());
+            offsets[clue][1] = static_cast<int>(partitions.size());
+            for (int parts = 1; parts <= MAX_NEIGHBOURS; ++parts) {
+                const std::vector<uint32_t>& list = byClue[clue][parts];
+                partitions.insert(partitions.end(), list.begin(), list.end());
+                offsets[clue][parts + 1] = static_cast<int>(partitions.size());
+            }
+        }
+    }
+
+    // Enumerates increasing sequences of distinct sums starting at `next`
+    static void collect(int next, int parts, int total, uint32_t mask,
+        std::vector<uint32_t> (&byClue)[MAX_CLUE + 1][MAX_NEIGHBOURS + 1]) {
+        if (parts > 0) {
+            byClue[total][parts].push_back(mask);
+        }
+        if (parts == MAX_NEIGHBOURS) return;
+        for (int sum = next; sum <= MAX_PIECE_SUM; ++sum) {
+            collect(sum + 1, parts + 1, total + sum, mask | (1u << sum), byClue);
+        }
+    }
+};
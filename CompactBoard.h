@@ -0,0 +1,336 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// Compact, trivially copyable board state shared by the engine, the hint
+// system and the solvers. Cells are stored with a fixed stride so that a
+// board can be copied with a single memcpy and handed to another thread.
+
+struct CompactPiece {
+    uint8_t value1;
+    uint8_t value2;
+    int8_t row;          // -1 while the piece is unplaced
+    int8_t col;
+    uint8_t vertical;    // 0 = horizontal, 1 = vertical (mirrors Orientation)
+    uint8_t placeOrder;  // 0 = unplaced, otherwise 1-based order of placement
+
+    int sum() const { return value1 + value2; }
+    uint32_t digitMask() const { return (1u << value1) | (1u << value2); }
+    bool isPlaced() const { return row >= 0; }
+};
+
+// A single placement on a compact board, as produced by the hint engines
+struct CompactMove {
+    int piece;           // index into the board's piece pool
+    int value1, value2;
+    int row, col;
+    int vertical;
+};
+
+enum class PlacementConflict {
+    NONE,
+    OUT_OF_BOUNDS,
+    ALREADY_PLACED,
+    OCCUPIED,
+    CLUE_CELL,
+    TOUCH,
+    ROW_DIGIT,
+    COLUMN_DIGIT,
+    DUPLICATE_SUM
+};
+
+class CompactBoard {
+public:
+    static const int MAX_SIZE = 20;
+    static const int MAX_CELLS = MAX_SIZE * MAX_SIZE;
+    static const int MAX_PIECES = 64;
+    static const int MAX_DIGIT = 31;
+    static const int MAX_SUM = 63;
+
+    CompactBoard() {
+        reset(0);
+    }
+
+    void reset(int size) {
+        gridSize = static_cast<uint8_t>(size);
+        numPieces = 0;
+        numPlaced = 0;
+        enforceUniqueSums = true;
+        std::memset(clues, 0, sizeof(clues));
+        std::memset(owner, -1, sizeof(owner));
+        std::memset(occupiedRows, 0, sizeof(occupiedRows));
+        std::memset(rowDigitMask, 0, sizeof(rowDigitMask));
+        std::memset(colDigitMask, 0, sizeof(colDigitMask));
+        usedSumMask = 0;
+        std::memset(pieces, 0, sizeof(pieces));
+    }
+
+    // Pool management
+    int addPiece(int v1, int v2) {
+        if (numPieces >= MAX_PIECES || v1 < 0 || v2 < 0 || v1 > MAX_DIGIT || v2 > MAX_DIGIT) {
+            return -1;
+        }
+        CompactPiece& piece = pieces[numPieces];
+        piece.value1 = static_cast<uint8_t>(v1);
+        piece.value2 = static_cast<uint8_t>(v2);
+        piece.row = -1;
+        piece.col = -1;
+        piece.vertical = 0;
+        piece.placeOrder = 0;
+        return numPieces++;
+    }
+
+    // Returns the first piece with the given values (in either order), preferring unplaced ones
+    int findPiece(int v1, int v2) const {
+        int placedMatch = -1;
+        for (int i = 0; i < numPieces; ++i) {
+            const CompactPiece& p = pieces[i];
+            if ((p.value1 == v1 && p.value2 == v2) || (p.value1 == v2 && p.value2 == v1)) {
+                if (!p.isPlaced()) return i;
+                if (placedMatch == -1) placedMatch = i;
+            }
+        }
+        return placedMatch;
+    }
+
+    void setClue(int row, int col, int value) {
+        clues[cellIndex(row, col)] = static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    void setEnforceUniqueSums(bool enforce) { enforceUniqueSums = enforce; }
+
+    // Queries
+    int size() const { return gridSize; }
+    int pieceCount() const { return numPieces; }
+    int placedCount() const { return numPlaced; }
+    const CompactPiece& piece(int index) const { return pieces[index]; }
+    int getClue(int row, int col) const { return clues[cellIndex(row, col)]; }
+    int ownerAt(int row, int col) const { return owner[cellIndex(row, col)]; }
+    bool isOccupied(int row, int col) const { return (occupiedRows[row] >> col) & 1u; }
+    uint32_t occupiedRow(int row) const { return occupiedRows[row]; }
+    uint32_t rowDigits(int row) const { return rowDigitMask[row]; }
+    uint32_t colDigits(int col) const { return colDigitMask[col]; }
+    uint64_t usedSums() const { return usedSumMask; }
+    bool uniqueSumsEnforced() const { return enforceUniqueSums; }
+    bool isComplete() const { return numPieces > 0 && numPlaced == numPieces; }
+
+    static int cellIndex(int row, int col) { return row * MAX_SIZE + col; }
+
+    // Checks the player rules for placing an unplaced piece; no allocation, O(1) in the grid size
+    PlacementConflict checkPlacement(int index, int row, int col, int vertical) const {
+        int row2 = vertical ? row + 1 : row;
+        int col2 = vertical ? col : col + 1;
+        if (row < 0 || col < 0 || row2 >= gridSize || col2 >= gridSize) {
+            return PlacementConflict::OUT_OF_BOUNDS;
+        }
+
+        const CompactPiece& p = pieces[index];
+        if (p.isPlaced()) return PlacementConflict::ALREADY_PLACED;
+
+        if (isOccupied(row, col) || isOccupied(row2, col2)) {
+            return PlacementConflict::OCCUPIED;
+        }
+        if (clues[cellIndex(row, col)] > 0 || clues[cellIndex(row2, col2)] > 0) {
+            return PlacementConflict::CLUE_CELL;
+        }
+        if (touchesPlaced(row, col, row2, col2)) {
+            return PlacementConflict::TOUCH;
+        }
+
+        // A double repeats its digit along the line it lies on
+        if (p.value1 == p.value2) {
+            return vertical ? PlacementConflict::COLUMN_DIGIT : PlacementConflict::ROW_DIGIT;
+        }
+
+        uint32_t digits = p.digitMask();
+        if ((rowDigitMask[row] & digits) || (rowDigitMask[row2] & digits)) {
+            return PlacementConflict::ROW_DIGIT;
+        }
+        if ((colDigitMask[col] & digits) || (colDigitMask[col2] & digits)) {
+            return PlacementConflict::COLUMN_DIGIT;
+        }
+        if (enforceUniqueSums && ((usedSumMask >> p.sum()) & 1u)) {
+            return PlacementConflict::DUPLICATE_SUM;
+        }
+        return PlacementConflict::NONE;
+    }
+
+    bool canPlace(int index, int row, int col, int vertical) const {
+        return checkPlacement(index, row, col, vertical) == PlacementConflict::NONE;
+    }
+
+    bool place(int index, int row, int col, int vertical) {
+        if (!canPlace(index, row, col, vertical)) return false;
+        placeUnchecked(index, row, col, vertical);
+        return true;
+    }
+
+    // Records a placement without validating it, for state that was already validated elsewhere
+    void placeUnchecked(int index, int row, int col, int vertical) {
+        CompactPiece& p = pieces[index];
+        int row2 = vertical ? row + 1 : row;
+        int col2 = vertical ? col : col + 1;
+
+        p.row = static_cast<int8_t>(row);
+        p.col = static_cast<int8_t>(col);
+        p.vertical = static_cast<uint8_t>(vertical ? 1 : 0);
+        p.placeOrder = static_cast<uint8_t>(++numPlaced);
+
+        owner[cellIndex(row, col)] = static_cast<int8_t>(index);
+        owner[cellIndex(row2, col2)] = static_cast<int8_t>(index);
+        occupiedRows[row] |= 1u << col;
+        occupiedRows[row2] |= 1u << col2;
+
+        uint32_t digits = p.digitMask();
+        rowDigitMask[row] |= digits;
+        rowDigitMask[row2] |= digits;
+        colDigitMask[col] |= digits;
+        colDigitMask[col2] |= digits;
+        usedSumMask |= uint64_t(1) << p.sum();
+    }
+
+    void remove(int index) {
+        CompactPiece& p = pieces[index];
+        if (!p.isPlaced()) return;
+
+        int row = p.row, col = p.col;
+        int row2 = p.vertical ? row + 1 : row;
+        int col2 = p.vertical ? col : col + 1;
+        int order = p.placeOrder;
+
+        owner[cellIndex(row, col)] = -1;
+        owner[cellIndex(row2, col2)] = -1;
+        occupiedRows[row] &= ~(1u << col);
+        occupiedRows[row2] &= ~(1u << col2);
+
+        // Lines hold each digit at most once, so clearing this piece's bits is exact
+        uint32_t digits = p.digitMask();
+        rowDigitMask[row] &= ~digits;
+        rowDigitMask[row2] &= ~digits;
+        colDigitMask[col] &= ~digits;
+        colDigitMask[col2] &= ~digits;
+        if (!sumUsedByOther(index, p.sum())) {
+            usedSumMask &= ~(uint64_t(1) << p.sum());
+        }
+
+        p.row = -1;
+        p.col = -1;
+        p.placeOrder = 0;
+        --numPlaced;
+        for (int i = 0; i < numPieces; ++i) {
+            if (pieces[i].placeOrder > order) --pieces[i].placeOrder;
+        }
+    }
+
+    // Sum of the distinct placed pieces adjacent (8-neighbourhood) to a cell
+    int adjacentSum(int row, int col) const {
+        int pieceCount;
+        return adjacentSum(row, col, pieceCount);
+    }
+
+    // Same, also reporting how many distinct pieces contributed
+    int adjacentSum(int row, int col, int& pieceCount) const {
+        int seen[8];
+        int seenCount = 0;
+        int sum = 0;
+        for (int dr = -1; dr <= 1; ++dr) {
+            int r = row + dr;
+            if (r < 0 || r >= gridSize) continue;
+            for (int dc = -1; dc <= 1; ++dc) {
+                int c = col + dc;
+                if ((dr == 0 && dc == 0) || c < 0 || c >= gridSize) continue;
+                int id = owner[cellIndex(r, c)];
+                if (id < 0) continue;
+                bool duplicate = false;
+                for (int i = 0; i < seenCount; ++i) {
+                    if (seen[i] == id) { duplicate = true; break; }
+                }
+                if (!duplicate) {
+                    seen[seenCount++] = id;
+                    sum += pieces[id].sum();
+                }
+            }
+        }
+        pieceCount = seenCount;
+        return sum;
+    }
+
+    bool cluesSatisfied() const {
+        for (int row = 0; row < gridSize; ++row) {
+            for (int col = 0; col < gridSize; ++col) {
+                int clue = clues[cellIndex(row, col)];
+                if (clue > 0 && adjacentSum(row, col) != clue) return false;
+            }
+        }
+        return true;
+    }
+
+    bool isSolved() const {
+        return isComplete() && cluesSatisfied();
+    }
+
+    // Replays the placements in order and checks each against the player rules
+    bool isLegal() const {
+        CompactBoard replay = *this;
+        for (int i = 0; i < numPieces; ++i) {
+            replay.remove(i);
+        }
+        for (int order = 1; order <= numPlaced; ++order) {
+            for (int i = 0; i < numPieces; ++i) {
+                const CompactPiece& p = pieces[i];
+                if (p.placeOrder == order) {
+                    if (!replay.place(i, p.row, p.col, p.vertical)) return false;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    bool touchesPlaced(int row, int col, int row2, int col2) const {
+        int top = row > 0 ? row - 1 : row;
+        int bottom = row2 + 1 < gridSize ? row2 + 1 : row2;
+        int left = col > 0 ? col - 1 : col;
+        int right = col2 + 1 < gridSize ? col2 + 1 : col2;
+        uint32_t span = ((1u << (right - left + 1)) - 1u) << left;
+        for (int r = top; r <= bottom; ++r) {
+            if (occupiedRows[r] & span) return true;
+        }
+        return false;
+    }
+
+    bool sumUsedByOther(int index, int sum) const {
+        for (int i = 0; i < numPieces; ++i) {
+            if (i != index && pieces[i].isPlaced() && pieces[i].sum() == sum) return true;
+        }
+        return false;
+    }
+
+    uint8_t gridSize;
+    uint8_t numPieces;
+    uint8_t numPlaced;
+    bool enforceUniqueSums;
+    uint8_t clues[MAX_CELLS];
+    int8_t owner[MAX_CELLS];
+    uint32_t occupiedRows[MAX_SIZE];
+    uint32_t rowDigitMask[MAX_SIZE];
+    uint32_t colDigitMask[MAX_SIZE];
+    uint64_t usedSumMask;
+    CompactPiece pieces[MAX_PIECES];
+};
+
+// Immutable view of a game at a given state version. Snapshots are handed out
+// as shared_ptr<const>, so any number of worker threads can read one while the
+// UI thread keeps mutating the live game. The solution board never changes for
+// a generated puzzle and is shared between every snapshot of that puzzle.
+struct BoardSnapshot {
+    uint64_t version;
+    CompactBoard board;
+    std::shared_ptr<const CompactBoard> solution;
+
+    BoardSnapshot() : version(0) {}
+};
+
+using SnapshotPtr = std::shared_ptr<const BoardSnapshot>;
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE 802.3, reflected, as used by zip and png) for on-disk records
+class Crc32 {
+public:
+    static uint32_t compute(const void* data, size_t length, uint32_t previous = 0) {
+        const uint32_t* table = instance().table;
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint32_t crc = ~previous;
+        for (size_t i = 0; i < length; ++i) {
+            crc = table[(crc ^ bytes[i]) & 0xFFu] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+private:
+    uint32_t table[256];
+
+    static const Crc32& instance() {
+        static const Crc32 crc;
+        return crc;
+    }
+
+    Crc32() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1u) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            table[i] = value;
+        }
+    }
+};
@@ -0,0 +1,531 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <bitset>
+#include "CompactBoard.h"
+#include "ClueSumTables.h"
+
+// Rules the deduction engine can apply. Elimination rules remove candidate
+// placements; forcing rules pin a piece to a single placement.
+enum class DeductionRule {
+    NONE = 0,
+    SINGLE_PLACEMENT,        // forcing: a piece has exactly one placement left
+    CLUE_SINGLE_SUPPLIER,    // forcing: an unsatisfied clue can be reached by only one placement
+    CLUE_SUM_BOUNDS,         // elimination: placement would overshoot a clue
+    LINE_DIGIT_EXCLUSION,    // elimination: shares a row/column digit with a forced piece
+    NO_TOUCH_EXCLUSION,      // elimination: overlaps or touches a forced piece
+    SUM_EXCLUSION,           // elimination: same sum as a forced piece
+    RULE_COUNT
+};
+
+inline uint32_t ruleBit(DeductionRule rule) {
+    return 1u << static_cast<int>(rule);
+}
+
+inline const char* ruleName(DeductionRule rule) {
+    switch (rule) {
+    case DeductionRule::SINGLE_PLACEMENT: return "single placement";
+    case DeductionRule::CLUE_SINGLE_SUPPLIER: return "clue single supplier";
+    case DeductionRule::CLUE_SUM_BOUNDS: return "clue sum bounds";
+    case DeductionRule::LINE_DIGIT_EXCLUSION: return "row/column digit exclusion";
+    case DeductionRule::NO_TOUCH_EXCLUSION: return "no-touch exclusion";
+    case DeductionRule::SUM_EXCLUSION: return "sum exclusion";
+    default: return "none";
+    }
+}
+
+struct Deduction {
+    bool found;
+    bool contradiction;      // the board cannot be completed
+    CompactMove move;
+    DeductionRule rule;
+
+    Deduction() : found(false), contradiction(false), move(), rule(DeductionRule::NONE) {}
+};
+
+// Placement ids use the board's fixed stride: id = cellIndex(row, col) * 2 + vertical.
+// The geometry does not depend on the grid size (ids that fall off a smaller board
+// never become candidates), so a single set of tables serves every board.
+class PlacementGeometry {
+public:
+    static const int PLACEMENTS = CompactBoard::MAX_CELLS * 2;
+    static const int WORDS = (PLACEMENTS + 63) / 64;
+
+    typedef uint64_t Bits[WORDS];
+
+    Bits adjacentToCell[CompactBoard::MAX_CELLS];   // placements with a cell in the 8-neighbourhood
+    Bits haloOf[PLACEMENTS];                        // placements that overlap or touch this one
+    Bits inRow[CompactBoard::MAX_SIZE];             // placements covering a row
+    Bits inCol[CompactBoard::MAX_SIZE];             // placements covering a column
+
+    static const PlacementGeometry& instance() {
+        static const PlacementGeometry geometry;
+        return geometry;
+    }
+
+    static int rowOf(int id) { return (id >> 1) / CompactBoard::MAX_SIZE; }
+    static int colOf(int id) { return (id >> 1) % CompactBoard::MAX_SIZE; }
+    static int verticalOf(int id) { return id & 1; }
+
+    static void setBit(uint64_t* bits, int id) { bits[id >> 6] |= uint64_t(1) << (id & 63); }
+    static bool testBit(const uint64_t* bits, int id) { return (bits[id >> 6] >> (id & 63)) & 1u; }
+
+private:
+    PlacementGeometry() {
+        const int n = CompactBoard::MAX_SIZE;
+        std::memset(this, 0, sizeof(PlacementGeometry));
+
+        for (int id = 0; id < PLACEMENTS; ++id) {
+            int row = rowOf(id), col = colOf(id), vertical = verticalOf(id);
+            int row2 = vertical ? row + 1 : row;
+            int col2 = vertical ? col : col + 1;
+            if (row2 >= n || col2 >= n) continue;
+
+            setBit(inRow[row], id);
+            setBit(inRow[row2], id);
+            setBit(inCol[col], id);
+            setBit(inCol[col2], id);
+
+            for (int r = row - 1; r <= row2 + 1; ++r) {
+                for (int c = col - 1; c <= col2 + 1; ++c) {
+                    if (r < 0 || c < 0 || r >= n || c >= n) continue;
+                    bool ownCell = (r == row && c == col) || (r == row2 && c == col2);
+                    if (!ownCell) {
+                        setBit(adjacentToCell[CompactBoard::cellIndex(r, c)], id);
+                    }
+                }
+            }
+        }
+
+        // Two placements conflict when any cell of one is within one step of any cell of the other
+        for (int id = 0; id < PLACEMENTS; ++id) {
+            int row = rowOf(id), col = colOf(id), vertical = verticalOf(id);
+            int row2 = vertical ? row + 1 : row;
+            int col2 = vertical ? col : col + 1;
+            if (row2 >= n || col2 >= n) continue;
+
+            for (int other = 0; other < PLACEMENTS; ++other) {
+                int orow = rowOf(other), ocol = colOf(other), overt = verticalOf(other);
+                int orow2 = overt ? orow + 1 : orow;
+                int ocol2 = overt ? ocol : ocol + 1;
+                if (orow2 >= n || ocol2 >= n) continue;
+                if (orow > row2 + 1 || orow2 < row - 1 || ocol > col2 + 1 || ocol2 < col - 1) continue;
+                setBit(haloOf[id], other);
+            }
+        }
+    }
+};
+
+// Rule-based propagator over a compact board. Candidate placements for every
+// unplaced piece are kept as bitsets; elimination rules run to a fixpoint and
+// the forced placements they expose are reported with the rule that found them.
+class DeductionEngine {
+public:
+    static const int MAX_CLUE_NEIGHBOURS = 4;
+
+private:
+    typedef PlacementGeometry::Bits Bits;
+
+    CompactBoard board;
+    int activeWords;                                // words that can hold placements on this board size
+    Bits candidates[CompactBoard::MAX_PIECES];
+    int16_t committed[CompactBoard::MAX_PIECES];   // placement id once a piece is forced, else -1
+
+    // Forced placements in the order they were discovered
+    CompactMove forced[CompactBoard::MAX_PIECES];
+    DeductionRule forcedRule[CompactBoard::MAX_PIECES];
+    int forcedCount;
+
+    bool contradiction;
+    bool settled;                                   // candidates are at a fixpoint of the rules
+    uint32_t rulesUsed;
+    uint32_t eliminations[static_cast<int>(DeductionRule::RULE_COUNT)];
+
+public:
+    explicit DeductionEngine(const CompactBoard& start) {
+        reset(start);
+    }
+
+    void reset(const CompactBoard& start) {
+        board = start;
+        activeWords = start.size() > 0
+            ? (CompactBoard::cellIndex(start.size() - 1, start.size() - 1) * 2 + 1) / 64 + 1
+            : 0;
+        forcedCount = 0;
+        contradiction = false;
+        settled = false;
+        rulesUsed = 0;
+        std::memset(eliminations, 0, sizeof(eliminations));
+        std::memset(candidates, 0, sizeof(candidates));
+
+        // Placements every piece may use: on the board, on free non-clue cells, clear of placed pieces
+        const PlacementGeometry& geo = PlacementGeometry::instance();
+        const int n = board.size();
+        Bits open = { 0 };
+        for (int row = 0; row < n; ++row) {
+            for (int col = 0; col < n; ++col) {
+                if (board.isOccupied(row, col) || board.getClue(row, col) > 0) continue;
+                if (col + 1 < n && !board.isOccupied(row, col + 1) && board.getClue(row, col + 1) == 0) {
+                    PlacementGeometry::setBit(open, encode(row, col, 0));
+                }
+                if (row + 1 < n && !board.isOccupied(row + 1, col) && board.getClue(row + 1, col) == 0) {
+                    PlacementGeometry::setBit(open, encode(row, col, 1));
+                }
+            }
+        }
+        for (int p = 0; p < board.pieceCount(); ++p) {
+            const CompactPiece& placed = board.piece(p);
+            if (!placed.isPlaced()) continue;
+            int id = encode(placed.row, placed.col, placed.vertical);
+            for (int w = 0; w < activeWords; ++w) open[w] &= ~geo.haloOf[id][w];
+        }
+
+        // Then the piece's own digits and sum, as CompactBoard::checkPlacement applies them
+        for (int p = 0; p < board.pieceCount(); ++p) {
+            committed[p] = -1;
+            const CompactPiece& piece = board.piece(p);
+            if (piece.isPlaced()) continue;
+            if (piece.value1 == piece.value2) continue;
+            if (board.uniqueSumsEnforced() && ((board.usedSums() >> piece.sum()) & 1u)) continue;
+
+            std::memcpy(candidates[p], open, sizeof(Bits));
+            uint32_t digits = piece.digitMask();
+            for (int line = 0; line < n; ++line) {
+                if (board.rowDigits(line) & digits) {
+                    for (int w = 0; w < activeWords; ++w) candidates[p][w] &= ~geo.inRow[line][w];
+                }
+                if (board.colDigits(line) & digits) {
+                    for (int w = 0; w < activeWords; ++w) candidates[p][w] &= ~geo.inCol[line][w];
+                }
+            }
+        }
+    }
+
+    // Applies elimination rules until nothing changes. Returns false on contradiction.
+    bool propagate() {
+        if (settled) return !contradiction;
+
+        bool changed = true;
+        while (changed && !contradiction) {
+            changed = false;
+
+            for (int p = 0; p < board.pieceCount() && !contradiction; ++p) {
+                if (board.piece(p).isPlaced() || committed[p] >= 0) continue;
+                int count = countBits(candidates[p]);
+                if (count == 0) {
+                    contradiction = true;
+                }
+                else if (count == 1) {
+                    commit(p, firstBit(candidates[p]), DeductionRule::SINGLE_PLACEMENT);
+                    changed = true;
+                }
+            }
+
+            for (int row = 0; row < board.size() && !contradiction; ++row) {
+                for (int col = 0; col < board.size() && !contradiction; ++col) {
+                    if (board.getClue(row, col) > 0 && applyClueRules(row, col)) {
+                        changed = true;
+                    }
+                }
+            }
+        }
+        settled = true;
+        return !contradiction;
+    }
+
+    // Propagates to a fixpoint and returns the earliest forced placement still open
+    Deduction nextForcedMove() {
+        Deduction result;
+        if (!propagate()) {
+            result.contradiction = true;
+            return result;
+        }
+        for (int i = 0; i < forcedCount; ++i) {
+            if (!board.piece(forced[i].piece).isPlaced()) {
+                result.found = true;
+                result.move = forced[i];
+                result.rule = forcedRule[i];
+                return result;
+            }
+        }
+        return result;
+    }
+
+    // Places a forced move on the engine's board. Its exclusions were applied when it was forced,
+    // so the candidates stay at their fixpoint.
+    void apply(const Deduction& deduction) {
+        if (!deduction.found) return;
+        const CompactMove& m = deduction.move;
+        board.placeUnchecked(m.piece, m.row, m.col, m.vertical);
+        std::memset(candidates[m.piece], 0, sizeof(Bits));
+        committed[m.piece] = -1;
+    }
+
+    // Commits a placement chosen from outside the rules (a guess); false if the rules already exclude it
+    bool assume(int piece, int row, int col, int vertical) {
+        if (contradiction || board.piece(piece).isPlaced()) return false;
+        int id = encode(row, col, vertical);
+        if (!PlacementGeometry::testBit(candidates[piece], id)) return false;
+
+        commit(piece, id, DeductionRule::NONE);
+        board.placeUnchecked(piece, row, col, vertical);
+        std::memset(candidates[piece], 0, sizeof(Bits));
+        committed[piece] = -1;
+        return !contradiction;
+    }
+
+    const CompactBoard& getBoard() const { return board; }
+    bool hasContradiction() const { return contradiction; }
+    uint32_t getRulesUsed() const { return rulesUsed; }
+    uint32_t getEliminations(DeductionRule rule) const { return eliminations[static_cast<int>(rule)]; }
+    int candidateCount(int piece) const { return countBits(candidates[piece]); }
+
+    // Candidate placement of a piece with the fewest options; -1 when every piece is placed or forced
+    int mostConstrainedPiece() const {
+        int best = -1, bestCount = 0;
+        for (int p = 0; p < board.pieceCount(); ++p) {
+            if (board.piece(p).isPlaced() || committed[p] >= 0) continue;
+            int count = countBits(candidates[p]);
+            if (best == -1 || count < bestCount) {
+                best = p;
+                bestCount = count;
+            }
+        }
+        return best;
+    }
+
+    // Calls fn(row, col, vertical) for each remaining candidate of a piece
+    template <typename Fn>
+    void forEachCandidate(int piece, Fn fn) const {
+        for (int w = 0; w < activeWords; ++w) {
+            uint64_t bits = candidates[piece][w];
+            while (bits) {
+                int id = w * 64 + lowestBit(bits);
+                bits &= bits - 1;
+                fn(PlacementGeometry::rowOf(id), PlacementGeometry::colOf(id), PlacementGeometry::verticalOf(id));
+            }
+        }
+    }
+
+private:
+    static int encode(int row, int col, int vertical) {
+        return CompactBoard::cellIndex(row, col) * 2 + vertical;
+    }
+
+    static int lowestBit(uint64_t bits) {
+        int index = 0;
+        while (!(bits & 1u)) {
+            bits >>= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    int countBits(const Bits& bits) const {
+        int count = 0;
+        for (int w = 0; w < activeWords; ++w) {
+            count += static_cast<int>(std::bitset<64>(bits[w]).count());
+        }
+        return count;
+    }
+
+    int firstBit(const Bits& bits) const {
+        for (int w = 0; w < activeWords; ++w) {
+            if (bits[w]) return w * 64 + lowestBit(bits[w]);
+        }
+        return -1;
+    }
+
+    // Clears mask bits from a piece's candidates; returns how many were removed
+    int eliminate(int piece, const uint64_t* mask, bool keepMask, DeductionRule rule) {
+        int removed = 0;
+        for (int w = 0; w < activeWords; ++w) {
+            uint64_t before = candidates[piece][w];
+            uint64_t after = keepMask ? (before & mask[w]) : (before & ~mask[w]);
+            if (after != before) {
+                removed += static_cast<int>(std::bitset<64>(before & ~after).count());
+                candidates[piece][w] = after;
+            }
+        }
+        if (removed > 0) {
+            eliminations[static_cast<int>(rule)] += removed;
+            rulesUsed |= ruleBit(rule);
+        }
+        return removed;
+    }
+
+    // Pins a piece to one placement and removes every placement of other pieces it rules out
+    void commit(int piece, int id, DeductionRule rule) {
+        const PlacementGeometry& geo = PlacementGeometry::instance();
+        committed[piece] = static_cast<int16_t>(id);
+        settled = false;
+        std::memset(candidates[piece], 0, sizeof(Bits));
+        PlacementGeometry::setBit(candidates[piece], id);
+        if (rule != DeductionRule::NONE) rulesUsed |= ruleBit(rule);
+
+        const CompactPiece& p = board.piece(piece);
+        int row = PlacementGeometry::rowOf(id), col = PlacementGeometry::colOf(id);
+        int vertical = PlacementGeometry::verticalOf(id);
+        forced[forcedCount] = { piece, p.value1, p.value2, row, col, vertical };
+        forcedRule[forcedCount] = rule;
+        ++forcedCount;
+
+        int row2 = vertical ? row + 1 : row;
+        int col2 = vertical ? col : col + 1;
+        uint32_t digits = p.digitMask();
+
+        for (int q = 0; q < board.pieceCount(); ++q) {
+            if (q == piece || board.piece(q).isPlaced()) continue;
+            const CompactPiece& other = board.piece(q);
+
+            eliminate(q, geo.haloOf[id], false, DeductionRule::NO_TOUCH_EXCLUSION);
+
+            if (other.digitMask() & digits) {
+                eliminate(q, geo.inRow[row], false, DeductionRule::LINE_DIGIT_EXCLUSION);
+                eliminate(q, geo.inCol[col], false, DeductionRule::LINE_DIGIT_EXCLUSION);
+                if (row2 != row) eliminate(q, geo.inRow[row2], false, DeductionRule::LINE_DIGIT_EXCLUSION);
+                if (col2 != col) eliminate(q, geo.inCol[col2], false, DeductionRule::LINE_DIGIT_EXCLUSION);
+            }
+
+            if (board.uniqueSumsEnforced() && other.sum() == p.sum()) {
+                eliminate(q, candidates[q], false, DeductionRule::SUM_EXCLUSION);
+            }
+
+            if (committed[q] >= 0 && !PlacementGeometry::testBit(candidates[q], committed[q])) {
+                contradiction = true;
+            }
+        }
+    }
+
+    // Clue sum bounds and single-supplier forcing for one clue cell. Returns true if anything changed.
+    bool applyClueRules(int row, int col) {
+        const PlacementGeometry& geo = PlacementGeometry::instance();
+        const uint64_t* adjacent = geo.adjacentToCell[CompactBoard::cellIndex(row, col)];
+
+        // Pieces already placed or forced next to the clue, plus pieces that can only go next to it
+        int neighbours = 0;
+        int deficit = board.getClue(row, col) - board.adjacentSum(row, col, neighbours);
+        int openPieces = 0;
+        int supplierPiece = -1, supplierId = -1, supplierCount = 0;
+        int largest[MAX_CLUE_NEIGHBOURS] = { 0 };
+        uint32_t openSums = 0;
+        bool useTables = board.uniqueSumsEnforced();
+
+        for (int p = 0; p < board.pieceCount(); ++p) {
+            if (board.piece(p).isPlaced()) continue;
+            int sum = board.piece(p).sum();
+
+            if (committed[p] >= 0) {
+                if (PlacementGeometry::testBit(adjacent, committed[p])) {
+                    deficit -= sum;
+                    ++neighbours;
+                }
+                continue;
+            }
+
+            bool touches = false, always = true;
+            for (int w = 0; w < activeWords; ++w) {
+                uint64_t c = candidates[p][w];
+                if (c & adjacent[w]) touches = true;
+                if (c & ~adjacent[w]) always = false;
+            }
+            if (!touches) continue;
+            if (always) {
+                deficit -= sum;
+                ++neighbours;
+                continue;
+            }
+
+            ++openPieces;
+            if (sum > ClueSumTables::MAX_PIECE_SUM) {
+                useTables = false;
+            }
+            else {
+                openSums |= 1u << sum;
+            }
+            for (int k = 0; k < MAX_CLUE_NEIGHBOURS; ++k) {
+                if (sum > largest[k]) {
+                    for (int j = MAX_CLUE_NEIGHBOURS - 1; j > k; --j) largest[j] = largest[j - 1];
+                    largest[k] = sum;
+                    break;
+                }
+            }
+        }
+
+        if (deficit < 0) {
+            contradiction = true;
+            return false;
+        }
+
+        // With unique sums the open neighbours must make up the deficit as a partition into distinct sums
+        uint32_t usable = ~0u, required = 0;
+        if (useTables) {
+            int slots = MAX_CLUE_NEIGHBOURS - neighbours;
+            if (!ClueSumTables::instance().partitionBounds(deficit, slots, openSums, usable, required)) {
+                contradiction = true;
+                return false;
+            }
+            usable |= 1u;   // a zero-sum piece never changes the clue
+        }
+        else {
+            int reachable = 0;
+            for (int k = 0; k < MAX_CLUE_NEIGHBOURS; ++k) reachable += largest[k];
+            if (reachable < deficit) {
+                contradiction = true;
+                return false;
+            }
+        }
+
+        // Optional neighbours may only take what the committed ones leave over
+        bool changed = false;
+        for (int p = 0; p < board.pieceCount(); ++p) {
+            if (board.piece(p).isPlaced() || committed[p] >= 0) continue;
+            int sum = board.piece(p).sum();
+            bool fits = sum <= deficit && (!useTables || ((usable >> sum) & 1u));
+            bool needed = useTables && ((required >> sum) & 1u) && countSum(sum) == 1;
+            if (fits && !needed) continue;
+
+            bool always = true, touches = false;
+            for (int w = 0; w < activeWords; ++w) {
+                if (candidates[p][w] & adjacent[w]) touches = true;
+                if (candidates[p][w] & ~adjacent[w]) always = false;
+            }
+            if (!touches || always) continue;
+
+            // A sum every partition needs, held by a single piece, pins that piece next to the clue
+            if (eliminate(p, adjacent, needed, DeductionRule::CLUE_SUM_BOUNDS) > 0) {
+                changed = true;
+            }
+        }
+
+        if (deficit > 0 && openPieces > 0) {
+            for (int p = 0; p < board.pieceCount() && supplierCount < 2; ++p) {
+                if (board.piece(p).isPlaced() || committed[p] >= 0) continue;
+                for (int w = 0; w < activeWords && supplierCount < 2; ++w) {
+                    uint64_t c = candidates[p][w] & adjacent[w];
+                    while (c && supplierCount < 2) {
+                        supplierPiece = p;
+                        supplierId = w * 64 + lowestBit(c);
+                        ++supplierCount;
+                        c &= c - 1;
+                    }
+                }
+            }
+            if (supplierCount == 1) {
+                commit(supplierPiece, supplierId, DeductionRule::CLUE_SINGLE_SUPPLIER);
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+    // Open pieces (neither placed nor forced) with the given sum
+    int countSum(int sum) const {
+        int count = 0;
+        for (int p = 0; p < board.pieceCount(); ++p) {
+            if (!board.piece(p).isPlaced() && committed[p] < 0 && board.piece(p).sum() == sum) ++count;
+        }
+        return count;
+    }
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include "CompactBoard.h"
+#include "DeductionEngine.h"
+#include "PuzzleSolver.h"
+
+// Trace of a human-style solve: deduce while something is forced, guess the
+// most constrained piece when nothing is
+struct DifficultyGrade {
+    bool solvable;          // false if no solution was found within the budget
+    int forcedSteps;        // placements found by deduction alone
+    int deductionDepth;     // longest run of forced placements between guesses
+    int branches;           // guesses needed when deduction stalls
+    double branchBits;      // log2 of the options at each guess, summed
+    uint32_t rulesUsed;     // DeductionRule bits needed along the way
+    int score;              // average cost per piece, 10 = every piece is a single placement
+    int tier;               // 0 = easy, 1 = medium, 2 = hard (same order as Difficulty)
+
+    DifficultyGrade() : solvable(false), forcedSteps(0), deductionDepth(0), branches(0), branchBits(0.0),
+        rulesUsed(0), score(0), tier(2) {}
+};
+
+// Grades a puzzle by replaying the deduction engine against a known solution.
+// The solution only decides guesses, so a grade costs one deduction pass over
+// the board and no search; a puzzle without a stored solution is solved first.
+class DifficultyGrader {
+public:
+    // Tier boundaries on score, calibrated on generated 8x8 to 12x12 puzzles
+    static const int EASY_MAX_SCORE = 18;
+    static const int MEDIUM_MAX_SCORE = 30;
+
+    // Step costs, in tenths of a trivial placement
+    static const int SINGLE_PLACEMENT_COST = 10;
+    static const int CLUE_SUPPLIER_COST = 20;
+    static const int CLUE_ARITHMETIC_COST = 5;
+    static const int GUESS_COST = 40;
+    static const int GUESS_BIT_COST = 10;
+
+    static DifficultyGrade grade(const CompactBoard& puzzle, const CompactBoard* solution = nullptr,
+        int solveBudgetMs = PuzzleSolver::DEFAULT_TIME_BUDGET_MS) {
+        if (solution) {
+            return gradeAgainst(puzzle, *solution);
+        }
+
+        PuzzleSolver solver(solveBudgetMs);
+        SolveResult solved = solver.solve(puzzle);
+        if (solved.status != SolveStatus::SOLVED) {
+            return DifficultyGrade();
+        }
+        return gradeAgainst(puzzle, solved.solution);
+    }
+
+    static int tierFor(int score) {
+        if (score <= EASY_MAX_SCORE) return 0;
+        if (score <= MEDIUM_MAX_SCORE) return 1;
+        return 2;
+    }
+
+    // Score in the middle of a tier's band; generators aim for it
+    static int targetScore(int tier) {
+        if (tier <= 0) return (SINGLE_PLACEMENT_COST + EASY_MAX_SCORE) / 2;
+        if (tier == 1) return (EASY_MAX_SCORE + MEDIUM_MAX_SCORE) / 2;
+        return MEDIUM_MAX_SCORE + (MEDIUM_MAX_SCORE - EASY_MAX_SCORE) / 2;
+    }
+
+private:
+    static DifficultyGrade gradeAgainst(const CompactBoard& puzzle, const CompactBoard& solution) {
+        DifficultyGrade result;
+        DeductionEngine engine(puzzle);
+        int cost = 0;
+        int run = 0;
+
+        while (!engine.getBoard().isComplete()) {
+            uint32_t arithmeticBefore = engine.getEliminations(DeductionRule::CLUE_SUM_BOUNDS);
+            Deduction forced = engine.nextForcedMove();
+            if (forced.contradiction) {
+                return DifficultyGrade();
+            }
+
+            if (forced.found) {
+                engine.apply(forced);
+                ++result.forcedSteps;
+                ++run;
+                if (run > result.deductionDepth) result.deductionDepth = run;
+                cost += forced.rule == DeductionRule::CLUE_SINGLE_SUPPLIER ? CLUE_SUPPLIER_COST : SINGLE_PLACEMENT_COST;
+                if (engine.getEliminations(DeductionRule::CLUE_SUM_BOUNDS) != arithmeticBefore) {
+                    cost += CLUE_ARITHMETIC_COST;
+                }
+                continue;
+            }
+
+            // Stalled: guess where the solution puts the piece with the fewest options
+            int piece = engine.mostConstrainedPiece();
+            if (piece < 0) {
+                return DifficultyGrade();
+            }
+            const CompactPiece& p = engine.getBoard().piece(piece);
+            int target = solution.findPiece(p.value1, p.value2);
+            if (target < 0 || !solution.piece(target).isPlaced()) {
+                return DifficultyGrade();
+            }
+
+            int options = engine.candidateCount(piece);
+            const CompactPiece& s = solution.piece(target);
+            if (!engine.assume(piece, s.row, s.col, s.vertical)) {
+                return DifficultyGrade();
+            }
+
+            double bits = std::log2(static_cast<double>(options));
+            ++result.branches;
+            result.branchBits += bits;
+            run = 0;
+            cost += GUESS_COST + static_cast<int>(GUESS_BIT_COST * bits + 0.5);
+        }
+
+        if (!engine.getBoard().cluesSatisfied()) {
+            return DifficultyGrade();
+        }
+
+        result.solvable = true;
+        result.rulesUsed = engine.getRulesUsed();
+        result.score = puzzle.pieceCount() > 0 ? cost / puzzle.pieceCount() : 0;
+        result.tier = tierFor(result.score);
+        return result;
+    }
+};
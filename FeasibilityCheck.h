@@ -0,0 +1,218 @@
+#pragma once
+#include <bitset>
+#include <cstdint>
+#include "CompactBoard.h"
+#include "ClueSumTables.h"
+
+// Why a board cannot be completed, as found by FeasibilityCheck
+enum class Infeasibility {
+    NONE,
+    DOUBLE_PIECE,       // a double repeats its digit along the line it lies on
+    DUPLICATE_SUMS,     // two remaining pieces share a sum, or a remaining sum is already used
+    AREA,               // the free area cannot hold the remaining pieces with their no-touch halos
+    LINE_DIGITS,        // rows and columns have too few free digits left for the remaining pieces
+    PIECE_DIGITS,       // a piece has no row and column with both of its digits still free
+    CLUE_UNREACHABLE    // a clue can no longer be made from the remaining sums
+};
+
+struct FeasibilityReport {
+    Infeasibility reason;
+    int piece;          // offending piece, or -1
+    int row, col;       // offending clue cell, or -1
+    int needed;         // for counting bounds: capacity the remaining pieces need
+    int available;      // and what the board still offers
+
+    FeasibilityReport() : reason(Infeasibility::NONE), piece(-1), row(-1), col(-1), needed(0), available(0) {}
+
+    bool isFeasible() const { return reason == Infeasibility::NONE; }
+
+    const char* describe() const {
+        switch (reason) {
+        case Infeasibility::DOUBLE_PIECE: return "a double cannot be placed without repeating a digit in its line";
+        case Infeasibility::DUPLICATE_SUMS: return "two pieces have the same sum";
+        case Infeasibility::AREA: return "not enough room for the remaining pieces and their no-touch halos";
+        case Infeasibility::LINE_DIGITS: return "rows and columns have too few free digits for the remaining pieces";
+        case Infeasibility::PIECE_DIGITS: return "a piece has no row and column with both of its digits free";
+        case Infeasibility::CLUE_UNREACHABLE: return "a clue can no longer be reached with the remaining sums";
+        default: return "feasible";
+        }
+    }
+};
+
+// Necessary conditions for completing a board, each computed in one pass over
+// the grid or the piece pool. Passing them proves nothing; failing any one of
+// them proves the board cannot be completed, so generators and solvers can
+// give up in microseconds instead of exhausting the search.
+class FeasibilityCheck {
+public:
+    static FeasibilityReport check(const CompactBoard& board) {
+        FeasibilityReport report;
+        if (checkPieces(board, report) && checkArea(board, report) &&
+            checkLineDigits(board, report) && checkClues(board, report)) {
+            return FeasibilityReport();
+        }
+        return report;
+    }
+
+private:
+    static int bitCount(uint64_t bits) {
+        return static_cast<int>(std::bitset<64>(bits).count());
+    }
+
+    // A cell a remaining piece could still cover: free, not a clue, clear of every placed piece's halo
+    static bool isOpen(const CompactBoard& board, int row, int col) {
+        if (board.isOccupied(row, col) || board.getClue(row, col) > 0) return false;
+        int n = board.size();
+        for (int r = row - 1; r <= row + 1; ++r) {
+            if (r < 0 || r >= n) continue;
+            uint32_t span = board.occupiedRow(r) >> (col > 0 ? col - 1 : 0);
+            if (span & (col > 0 ? 7u : 3u)) return false;
+        }
+        return true;
+    }
+
+    static bool checkPieces(const CompactBoard& board, FeasibilityReport& report) {
+        uint64_t remainingSums = 0;
+        for (int i = 0; i < board.pieceCount(); ++i) {
+            const CompactPiece& p = board.piece(i);
+            if (p.isPlaced()) continue;
+
+            if (p.value1 == p.value2) {
+                report.reason = Infeasibility::DOUBLE_PIECE;
+                report.piece = i;
+                return false;
+            }
+            if (board.uniqueSumsEnforced()) {
+                uint64_t bit = uint64_t(1) << p.sum();
+                if ((board.usedSums() | remainingSums) & bit) {
+                    report.reason = Infeasibility::DUPLICATE_SUMS;
+                    report.piece = i;
+                    return false;
+                }
+                remainingSums |= bit;
+            }
+        }
+        return true;
+    }
+
+    // Cells at Chebyshev distance two or more have disjoint 2x2 corner blocks, so each
+    // non-touching domino claims six corner points that no other piece shares
+    static bool checkArea(const CompactBoard& board, FeasibilityReport& report) {
+        int n = board.size();
+        uint32_t corners[CompactBoard::MAX_SIZE + 1] = { 0 };
+        for (int row = 0; row < n; ++row) {
+            for (int col = 0; col < n; ++col) {
+                if (!isOpen(board, row, col)) continue;
+                uint32_t block = 3u << col;
+                corners[row] |= block;
+                corners[row + 1] |= block;
+            }
+        }
+
+        int points = 0;
+        for (int row = 0; row <= n; ++row) {
+            points += bitCount(corners[row]);
+        }
+
+        int remaining = board.pieceCount() - board.placedCount();
+        if (remaining * 6 > points) {
+            report.reason = Infeasibility::AREA;
+            report.needed = remaining * 6;
+            report.available = points;
+            return false;
+        }
+        return true;
+    }
+
+    // Every line holds each digit once and a piece brings two digits to each line it touches.
+    // A horizontal piece touches one row and two columns, a vertical one the other way round,
+    // so three line slots per piece must fit into the rows' and columns' free digit pairs.
+    static bool checkLineDigits(const CompactBoard& board, FeasibilityReport& report) {
+        int n = board.size();
+        uint32_t alphabet = 0;
+        for (int i = 0; i < board.pieceCount(); ++i) {
+            alphabet |= board.piece(i).digitMask();
+        }
+
+        int openInRow[CompactBoard::MAX_SIZE] = { 0 };
+        int openInCol[CompactBoard::MAX_SIZE] = { 0 };
+        for (int row = 0; row < n; ++row) {
+            for (int col = 0; col < n; ++col) {
+                if (isOpen(board, row, col)) {
+                    ++openInRow[row];
+                    ++openInCol[col];
+                }
+            }
+        }
+
+        int capacity = 0;
+        for (int line = 0; line < n; ++line) {
+            int rowPairs = bitCount(alphabet & ~board.rowDigits(line)) / 2;
+            int colPairs = bitCount(alphabet & ~board.colDigits(line)) / 2;
+            capacity += rowPairs < openInRow[line] ? rowPairs : openInRow[line];
+            capacity += colPairs < openInCol[line] ? colPairs : openInCol[line];
+        }
+
+        int remaining = board.pieceCount() - board.placedCount();
+        if (remaining * 3 > capacity) {
+            report.reason = Infeasibility::LINE_DIGITS;
+            report.needed = remaining * 3;
+            report.available = capacity;
+            return false;
+        }
+
+        for (int i = 0; i < board.pieceCount(); ++i) {
+            const CompactPiece& p = board.piece(i);
+            if (p.isPlaced()) continue;
+
+            uint32_t digits = p.digitMask();
+            int rows = 0, cols = 0;
+            for (int line = 0; line < n; ++line) {
+                if (openInRow[line] > 0 && !(board.rowDigits(line) & digits)) ++rows;
+                if (openInCol[line] > 0 && !(board.colDigits(line) & digits)) ++cols;
+            }
+            if (!((rows >= 1 && cols >= 2) || (rows >= 2 && cols >= 1))) {
+                report.reason = Infeasibility::PIECE_DIGITS;
+                report.piece = i;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool checkClues(const CompactBoard& board, FeasibilityReport& report) {
+        bool useTables = board.uniqueSumsEnforced();
+        uint32_t available = 0;
+        for (int i = 0; i < board.pieceCount() && useTables; ++i) {
+            const CompactPiece& p = board.piece(i);
+            if (p.isPlaced()) continue;
+            if (p.sum() > ClueSumTables::MAX_PIECE_SUM) {
+                useTables = false;
+            }
+            else {
+                available |= 1u << p.sum();
+            }
+        }
+
+        const ClueSumTables& tables = ClueSumTables::instance();
+        for (int row = 0; row < board.size(); ++row) {
+            for (int col = 0; col < board.size(); ++col) {
+                int clue = board.getClue(row, col);
+                if (clue == 0) continue;
+
+                int neighbours = 0;
+                int deficit = clue - board.adjacentSum(row, col, neighbours);
+                bool reachable = deficit >= 0 &&
+                    (!useTables || tables.feasible(deficit, ClueSumTables::MAX_NEIGHBOURS - neighbours, available));
+                if (!reachable) {
+                    report.reason = Infeasibility::CLUE_UNREACHABLE;
+                    report.row = row;
+                    report.col = col;
+                    report.needed = deficit;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
@@ -27,15 +27,105 @@ BOOL CGameDoc::OnNewDocument()
     return TRUE;
 }
 
+// Document layout: magic, format version, difficulty, puzzle seed, hints used, won flag,
+// both grids row by row, then the available and placed dominoes, each list count-prefixed.
+// The seed is what GameLogic::GeneratePuzzle dealt the set from, so a saved game can be
+// dealt again. Documents from builds that stored nothing open as a new game.
+static const DWORD GAME_DOC_MAGIC = 0x445A5044;     // "DPZD"
+static const int GAME_DOC_VERSION = 1;
+
 void CGameDoc::Serialize(CArchive& ar)
 {
     if (ar.IsStoring())
     {
-        // TODO: Add storing code here
+        const GameState& state = m_gameState;
+        ar << GAME_DOC_MAGIC << GAME_DOC_VERSION;
+        ar << static_cast<int>(state.currentDifficulty) << static_cast<DWORD>(state.puzzleSeed)
+            << state.hintsUsed << static_cast<int>(state.gameWon);
+
+        for (int i = 0; i < GameState::GRID_SIZE; i++)
+        {
+            for (int j = 0; j < GameState::GRID_SIZE; j++)
+            {
+                ar << state.gameGrid[i][j] << state.dominoGrid[i][j];
+            }
+        }
+
+        ar << static_cast<int>(state.availableDominoes.size());
+        for (const Domino& domino : state.availableDominoes)
+        {
+            ar << domino.value1 << domino.value2 << static_cast<int>(domino.orientation);
+        }
+
+        ar << static_cast<int>(state.placedDominoes.size());
+        for (const PlacedDomino& placed : state.placedDominoes)
+        {
+            ar << placed.domino.value1 << placed.domino.value2 << placed.row << placed.col
+                << static_cast<int>(placed.orientation) << placed.id;
+        }
     }
     else
     {
-        // TODO: Add loading code here
+        CFile* file = ar.GetFile();
+        if (file && file->GetLength() == 0)
+            return;
+
+        DWORD magic = 0;
+        int version = 0;
+        ar >> magic >> version;
+        if (magic != GAME_DOC_MAGIC || version != GAME_DOC_VERSION)
+            AfxThrowArchiveException(CArchiveException::badSchema);
+
+        // Read into a fresh state, so a damaged document leaves the open game as it was
+        GameState loaded;
+        int difficulty = 0, won = 0;
+        DWORD seed = 0;
+        ar >> difficulty >> seed >> loaded.hintsUsed >> won;
+        if (difficulty < static_cast<int>(Difficulty::EASY) || difficulty > static_cast<int>(Difficulty::HARD))
+            AfxThrowArchiveException(CArchiveException::badSchema);
+        loaded.currentDifficulty = static_cast<Difficulty>(difficulty);
+        loaded.puzzleSeed = seed;
+        loaded.gameWon = won != 0;
+
+        for (int i = 0; i < GameState::GRID_SIZE; i++)
+        {
+            for (int j = 0; j < GameState::GRID_SIZE; j++)
+            {
+                ar >> loaded.gameGrid[i][j] >> loaded.dominoGrid[i][j];
+            }
+        }
+
+        int count = 0;
+        ar >> count;
+        if (count < 0 || count > GameState::TOTAL_DOMINOES)
+            AfxThrowArchiveException(CArchiveException::badSchema);
+        for (int i = 0; i < count; i++)
+        {
+            Domino domino;
+            int orientation = 0;
+            ar >> domino.value1 >> domino.value2 >> orientation;
+            domino.orientation = static_cast<Orientation>(orientation != 0);
+            loaded.availableDominoes.push_back(domino);
+        }
+
+        ar >> count;
+        if (count < 0 || count > GameState::TOTAL_DOMINOES)
+            AfxThrowArchiveException(CArchiveException::badSchema);
+        for (int i = 0; i < count; i++)
+        {
+            PlacedDomino placed;
+            int orientation = 0;
+            ar >> placed.domino.value1 >> placed.domino.value2 >> placed.row >> placed.col
+                >> orientation >> placed.id;
+            if (placed.row < 0 || placed.row >= GameState::GRID_SIZE ||
+                placed.col < 0 || placed.col >= GameState::GRID_SIZE)
+                AfxThrowArchiveException(CArchiveException::badSchema);
+            placed.orientation = static_cast<Orientation>(orientation != 0);
+            placed.domino.orientation = placed.orientation;
+            loaded.placedDominoes.push_back(placed);
+        }
+
+        m_gameState = loaded;
     }
 }
 
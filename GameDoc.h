@@ -1,5 +1,5 @@
 #pragma once
-#include "GameData.h"
+#include "GameState.h"
 
 class CGameDoc : public CDocument
 {
@@ -1,2 +1,4 @@
 #include "pch.h"
 #include "GameGrid.h"
+
+std::atomic<int> Domino::nextId(0);
@@ -13,6 +13,21 @@
 #include <fstream>
 #include <string>
 #include <unordered_map>
+#include <atomic>
+#include <cstring>
+#include "CompactBoard.h"
+#include "DifficultyGrader.h"
+#include "FeasibilityCheck.h"
+#include "PuzzleSolver.h"
+#include "CancellationToken.h"
+#include "SearchStats.h"
+#include "TraceRecorder.h"
+#include "AllocationTracker.h"
+#include "BitPacker.h"
+#include "LittleEndian.h"
+#include "Crc32.h"
+#include "MappedFile.h"
+#include "RandomStream.h"
 
 // Disable Windows min/max macros if they're defined
 #ifdef min
@@ -73,9 +88,14 @@ private:
     bool isPlaced;
     int uniqueId;
 
-    static int nextId;
+    static std::atomic<int> nextId;
 
 public:
+    Domino() : value1(0), value2(0), sum(0),
+        position(-1, -1), orientation(Orientation::HORIZONTAL),
+        isPlaced(false), uniqueId(nextId++) {
+    }
+
     Domino(int v1, int v2) : value1(v1), value2(v2), sum(v1 + v2),
         position(-1, -1), orientation(Orientation::HORIZONTAL),
         isPlaced(false), uniqueId(nextId++) {
@@ -191,7 +211,96 @@ public:
     }
 };
 
-int Domino::nextId = 0;
+// Outcome of a time-budgeted generateNewGame. A puzzle is installed whenever
+// success is set, even if the budget ran out before every target was met.
+struct GenerationResult {
+    bool success;               // a playable puzzle is installed
+    bool metTargets;            // full generator used and the grade reached the requested tier
+    bool timedOut;
+    bool cancelled;
+    bool simplified;            // fell back to the grid-pattern puzzle
+    int attempts;               // generator attempts started
+    uint64_t seed;              // the seed the puzzle was generated from
+    uint64_t nodes;             // backtracking nodes explored
+    SearchStats search;         // what the solution search did, over every attempt
+    DifficultyGrade grade;
+    FeasibilityReport infeasibility;
+
+    GenerationResult() : success(false), metTargets(false), timedOut(false), cancelled(false),
+        simplified(false), attempts(0), seed(0), nodes(0) {}
+};
+
+// Live counters for a generation in progress, readable from any thread
+struct GenerationProgress {
+    std::atomic<int> attempts;
+    std::atomic<uint64_t> nodes;
+
+    GenerationProgress() : attempts(0), nodes(0) {}
+};
+
+// Where a suspended solution search stands: the placement, (row * size + col) * 2
+// + vertical, of each piece on the current path, and the candidates not yet tried
+// at the shallowest level that has any. Replaying `path` up to `stealDepth` and
+// searching `untried` there covers exactly the subtree this search has left to do
+// at that level, which is the unit another worker would take over.
+struct SolutionFrontier {
+    std::vector<uint32_t> path;
+    int stealDepth;             // -1 when no level has candidates left
+    std::vector<uint32_t> untried;
+
+    SolutionFrontier() : stealDepth(-1) {}
+};
+
+// Generation parameters that decide which puzzles are interchangeable
+struct PuzzleKey {
+    int gridSize;
+    Difficulty difficulty;
+    bool extendedSet;
+
+    PuzzleKey(int size = 8, Difficulty level = Difficulty::EASY, bool extended = false)
+        : gridSize(size), difficulty(level), extendedSet(extended) {}
+};
+
+// A finished puzzle detached from any game: the visible clues and the solution
+// they were derived from. Generated on one DominoGame, installable on another.
+struct GeneratedPuzzle {
+    int gridSize;
+    bool extendedSet;
+    Difficulty difficulty;
+    std::vector<std::vector<int>> clues;
+    std::vector<Domino> solution;
+    DifficultyGrade grade;
+    bool seeded;                // seed is known; puzzles from caches and libraries do not carry it
+    uint64_t seed;
+
+    GeneratedPuzzle() : gridSize(0), extendedSet(false), difficulty(Difficulty::EASY), seeded(false), seed(0) {}
+
+    bool isValid() const { return gridSize > 0 && !solution.empty(); }
+
+    PuzzleKey key() const { return PuzzleKey(gridSize, difficulty, extendedSet); }
+};
+
+// How a save is restored. VALIDATED replays every placed piece through the move
+// rules; TRUSTED writes them straight into the board for saves this build wrote
+// itself, leaving rule checks to validatePlacements().
+enum class LoadMode {
+    VALIDATED,
+    TRUSTED
+};
+
+// One player action as the autosave journal stores it. RESET stands for a change
+// that replaces the whole state (new game, load, auto-solve) and needs a snapshot.
+struct MoveRecord {
+    enum Kind { PLACE, REMOVE, MOVE, HINT, RESET };
+
+    Kind kind;
+    int value1, value2;         // PLACE
+    Position from;              // REMOVE, MOVE
+    Position to;                // PLACE, MOVE: the first cell
+    Orientation orientation;    // PLACE, MOVE
+
+    explicit MoveRecord(Kind k = RESET) : kind(k), value1(0), value2(0), orientation(Orientation::HORIZONTAL) {}
+};
 
 class DominoGame {
 private:
@@ -199,10 +308,20 @@ private:
     static const int DEFAULT_GRID_SIZE = 8;
     static const int MAX_GRID_SIZE = 20;
     static const int MAX_GENERATION_ATTEMPTS = 100;
+    static const int DEFAULT_GENERATION_BUDGET_MS = 100;
+    static const int GENERATION_CHECK_INTERVAL = 64;
     static const int MAX_HINTS_ALLOWED = 3;
     static const int MIN_DOMINO_VALUE = 0;
     static const int MAX_DOMINO_VALUE = 9;
 
+    // Save format
+    static const uint32_t SAVE_MAGIC = 0x535A5044;     // "DPZS"
+    static const uint16_t SAVE_FORMAT_VERSION = 1;
+    static const size_t SAVE_HEADER_SIZE = 16;
+    static const uint16_t SAVE_EXTENDED_SET = 1;
+    static const uint16_t SAVE_HAS_SOLUTION = 2;
+    static const uint16_t SAVE_HAS_SEED = 4;
+
     // Game state
     int gridSize;
     std::vector<std::vector<int>> grid;
@@ -224,17 +343,99 @@ private:
     std::vector<Domino> solutionDominoes;
     bool hasSolution;
 
-    // Random number generator
-    std::mt19937 rng;
+    // Random streams: the generation's root, split once per attempt so an attempt's
+    // draws do not depend on how many the attempts before it consumed
+    RandomStream generationStreams;
+    RandomStream rng;
+
+    // The generator's solution search, kept here between steps so it can be suspended.
+    // One frame per depth, allocated once per generation.
+    enum class SearchStep { RUNNING, FOUND, EXHAUSTED, STOPPED };
+
+    struct SolutionFrame {
+        uint32_t placement;     // candidate on the board while its subtree is searched
+        bool placed;
+    };
+
+    std::vector<Domino> searchDominoes;
+    std::vector<LazyPermutation> placementOrders;
+    std::vector<SolutionFrame> solutionFrames;
+    int searchDepth;
+    bool searchEntering;        // the frame at searchDepth has not been entered yet
+
+    // Seed and generator version of the current puzzle, when it is known
+    bool hasPuzzleSeed;
+    uint64_t puzzleSeed;
+    int puzzleGeneratorVersion;
 
     // Cache for performance optimization
     mutable std::unordered_map<Position, int> constraintCache;
     mutable bool cacheValid;
 
+    // Snapshot support: bumped on every state change, snapshots are rebuilt lazily
+    uint64_t stateVersion;
+    mutable SnapshotPtr cachedSnapshot;
+    std::shared_ptr<const CompactBoard> solutionBoard;
+    std::vector<std::pair<int, std::function<void(uint64_t)>>> stateListeners;     // by subscription id
+    int lastStateListenerId;
+
+    // Wall-clock budget for solver-backed hints
+    int hintTimeBudgetMs;
+
+    // Solver trace of the current puzzle, filled in by applyDifficultySettings
+    DifficultyGrade puzzleGrade;
+
+    // Why the last generateNewGame skipped the full generator, if it did
+    FeasibilityReport generationReport;
+
+    // Budget of the generation in progress; unlimited outside generateNewGame
+    std::chrono::steady_clock::time_point generationDeadline;
+    CancellationToken generationCancel;
+    GenerationProgress* generationProgress;
+    uint64_t generationNodes;
+    SearchStats generationStats;
+    bool generationStopped;
+
+    // Per-move notifications; held back while a whole-state change is in progress
+    std::function<void(const MoveRecord&)> moveRecordedCallback;
+    int stateReplacementDepth;
+
+    uint64_t replacementStartVersion;
+
+    // Marks a whole-state change: moves and intermediate states inside it are not reported
+    // one by one. Once the outermost change completes, state-change listeners hear about
+    // the final state once and a single RESET record follows.
+    class StateReplacement {
+    private:
+        DominoGame& game;
+
+    public:
+        explicit StateReplacement(DominoGame& owner) : game(owner) {
+            if (game.stateReplacementDepth++ == 0) {
+                game.replacementStartVersion = game.stateVersion;
+            }
+        }
+        ~StateReplacement() {
+            if (--game.stateReplacementDepth == 0) {
+                if (game.stateVersion != game.replacementStartVersion) {
+                    game.notifyStateChanged();
+                }
+                game.recordMove(MoveRecord(MoveRecord::RESET));
+            }
+        }
+    };
+
 public:
+    // Bump whenever a change to the generator alters the puzzles it produces, so caches
+    // built by older versions are not served as if they came from this one
+    static const int GENERATOR_VERSION = 6;
+
     DominoGame(bool useExtended = false, int size = DEFAULT_GRID_SIZE)
         : gridSize(size), useExtendedSet(useExtended),
-        rng(std::chrono::steady_clock::now().time_since_epoch().count()) {
+        searchDepth(0), searchEntering(false), hasPuzzleSeed(false), puzzleSeed(0), puzzleGeneratorVersion(0),
+        stateVersion(0), lastStateListenerId(0), hintTimeBudgetMs(PuzzleSolver::DEFAULT_TIME_BUDGET_MS),
+        generationDeadline(std::chrono::steady_clock::time_point::max()), generationProgress(nullptr),
+        generationNodes(0), generationStopped(false), stateReplacementDepth(0), replacementStartVersion(0) {
         if (gridSize <= 0 || gridSize > MAX_GRID_SIZE) {
             throw std::invalid_argument("Invalid grid size");
         }
@@ -243,6 +444,7 @@ public:
 
     // Game control
     void initializeGame() {
+        StateReplacement replacing(*this);
         grid.assign(gridSize, std::vector<int>(gridSize, 0));
         dominoGrid.assign(gridSize, std::vector<int>(gridSize, -1));
         placedDominoes.clear();
@@ -251,31 +453,114 @@ public:
         hintsUsed = 0;
         movesCount = 0;
         hasSolution = false;
+        hasPuzzleSeed = false;
         cacheValid = false;
         constraintCache.clear();
         Domino::resetIdCounter();
         generateAvailableDominoes();
         gameStartTime = std::chrono::steady_clock::now();
+        solutionBoard.reset();
+        markStateChanged();
     }
 
+    // Interactive entry point: a fresh seed, generation bounded by DEFAULT_GENERATION_BUDGET_MS
     bool generateNewGame(Difficulty difficulty) {
-        currentDifficulty = difficulty;
-        initializeGame();
+        return generateNewGame(difficulty, makeSeed());
+    }
 
-        for (int attempt = 0; attempt < MAX_GENERATION_ATTEMPTS; ++attempt) {
-            if (generateSolution()) {
-                generateConstraintGrid();
-                applyDifficultySettings();
-                return true;
+    bool generateNewGame(Difficulty difficulty, uint64_t seed) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(DEFAULT_GENERATION_BUDGET_MS);
+        return generateNewGame(difficulty, seed, deadline).success;
+    }
+
+    // Generates until the deadline or cancellation. When time runs out the best puzzle so far is
+    // installed (a partial clue removal, or the simplified puzzle if no solution was found yet);
+    // a cancelled generation installs nothing.
+    // The same seed, difficulty, grid size, piece set and GENERATOR_VERSION give the same puzzle
+    // on every platform, provided the budget did not run out; a timed-out puzzle is not
+    // recorded as seeded.
+    GenerationResult generateNewGame(Difficulty difficulty, uint64_t seed, std::chrono::steady_clock::time_point deadline,
+        const CancellationToken& cancel = CancellationToken(), GenerationProgress* progress = nullptr) {
+        TRACE_SPAN("generateNewGame");
+        ALLOCATION_SCOPE("generateNewGame");
+        StateReplacement replacing(*this);
+        generationDeadline = deadline;
+        generationCancel = cancel;
+        generationProgress = progress;
+        generationNodes = 0;
+        generationStats.reset();
+        generationStopped = false;
+        generationStreams.reseed(seed);
+
+        GenerationResult result = runGeneration(difficulty);
+        result.seed = seed;
+        if (result.success && !result.timedOut) {
+            hasPuzzleSeed = true;
+            puzzleSeed = seed;
+            puzzleGeneratorVersion = GENERATOR_VERSION;
+        }
+
+        generationDeadline = std::chrono::steady_clock::time_point::max();
+        generationCancel = CancellationToken();
+        generationProgress = nullptr;
+        return result;
+    }
+
+    // Detaches the current puzzle so it can be installed elsewhere
+    GeneratedPuzzle exportPuzzle() const {
+        GeneratedPuzzle puzzle;
+        if (!hasSolution) return puzzle;
+
+        puzzle.gridSize = gridSize;
+        puzzle.extendedSet = useExtendedSet;
+        puzzle.difficulty = currentDifficulty;
+        puzzle.clues = grid;
+        for (const auto& domino : solutionDominoes) {
+            if (domino.getPosition().isValid()) {
+                puzzle.solution.push_back(domino);
             }
         }
+        puzzle.grade = puzzleGrade;
+        puzzle.seeded = hasPuzzleSeed && puzzleGeneratorVersion == GENERATOR_VERSION;
+        puzzle.seed = puzzleSeed;
+        return puzzle;
+    }
+
+    // A seed for a generation nobody asked to reproduce; read it back with getPuzzleSeed
+    static uint64_t makeSeed() {
+        std::random_device device;
+        uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+        return seed ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    // Starts a fresh game on a puzzle generated elsewhere
+    void installPuzzle(const GeneratedPuzzle& puzzle) {
+        if (!puzzle.isValid() || puzzle.gridSize != gridSize || puzzle.extendedSet != useExtendedSet) {
+            throw std::invalid_argument("Puzzle does not match this game");
+        }
 
-        std::cerr << "Warning: Failed to generate complex puzzle, creating simplified version\n";
-        return generateSimplifiedPuzzle(difficulty);
+        StateReplacement replacing(*this);
+        currentDifficulty = puzzle.difficulty;
+        initializeGame();
+
+        grid = puzzle.clues;
+        solutionGrid.assign(gridSize, std::vector<int>(gridSize, -1));
+        solutionDominoes.clear();
+        for (size_t i = 0; i < puzzle.solution.size(); ++i) {
+            const Domino& domino = puzzle.solution[i];
+            placeDominoInSolution(domino, domino.getPosition(), domino.getOrientation(), static_cast<int>(i));
+        }
+        hasSolution = true;
+        puzzleGrade = puzzle.grade;
+        hasPuzzleSeed = puzzle.seeded;
+        puzzleSeed = puzzle.seed;
+        puzzleGeneratorVersion = GENERATOR_VERSION;
+        publishSolution();
     }
 
     // Domino operations
     bool placeDomino(const Domino& domino, Position position, Orientation orientation) {
+        ALLOCATION_SCOPE("placeDomino");
         if (!position.isValidForGrid(gridSize) || !canPlaceDomino(domino, position, orientation)) {
             return false;
         }
@@ -305,10 +590,19 @@ public:
             gameCompleted = isValidSolution();
         }
 
+        markStateChanged();
+
+        MoveRecord record(MoveRecord::PLACE);
+        record.value1 = domino.getValue1();
+        record.value2 = domino.getValue2();
+        record.to = position;
+        record.orientation = orientation;
+        recordMove(record);
         return true;
     }
 
     bool removeDomino(Position position) {
+        ALLOCATION_SCOPE("removeDomino");
         if (!position.isValidForGrid(gridSize)) return false;
 
         int dominoId = dominoGrid[position.row][position.col];
@@ -329,11 +623,16 @@ public:
         movesCount++;
         gameCompleted = false;
         updateDominoIds();
+        markStateChanged();
 
+        MoveRecord record(MoveRecord::REMOVE);
+        record.from = position;
+        recordMove(record);
         return true;
     }
 
     bool moveDomino(Position from, Position to1, Position to2) {
+        ALLOCATION_SCOPE("moveDomino");
         if (!from.isValidForGrid(gridSize)) return false;
 
         int dominoId = dominoGrid[from.row][from.col];
@@ -375,7 +674,13 @@ public:
         movesCount++;
         constraintCache.clear();
         cacheValid = false;
+        markStateChanged();
 
+        MoveRecord record(MoveRecord::MOVE);
+        record.from = from;
+        record.to = to1;
+        record.orientation = newOrientation;
+        recordMove(record);
         return true;
     }
 
@@ -384,6 +689,15 @@ public:
     int getHintsUsed() const { return hintsUsed; }
     int getMovesCount() const { return movesCount; }
     Difficulty getDifficulty() const { return currentDifficulty; }
+    const DifficultyGrade& getPuzzleGrade() const { return puzzleGrade; }
+
+    // The seed that regenerates the current puzzle with generateNewGame, if known, and the
+    // GENERATOR_VERSION that produced it; a seed only reproduces the puzzle on that version
+    bool hasSeed() const { return hasPuzzleSeed; }
+    uint64_t getPuzzleSeed() const { return puzzleSeed; }
+    int getPuzzleGeneratorVersion() const { return puzzleGeneratorVersion; }
+
+    const FeasibilityReport& getGenerationReport() const { return generationReport; }
     int getGridSize() const { return gridSize; }
     bool isUsingExtendedSet() const { return useExtendedSet; }
     double getElapsedTime() const {
@@ -392,15 +706,138 @@ public:
     }
 
     const std::vector<std::vector<int>>& getGrid() const { return grid; }
+    const std::vector<std::vector<int>>& getDominoGrid() const { return dominoGrid; }
     const std::vector<Domino>& getAvailableDominoes() const { return availableDominoes; }
     const std::vector<Domino>& getPlacedDominoes() const { return placedDominoes; }
+    uint64_t getStateVersion() const { return stateVersion; }
+
+    // Invoked on the mutating thread with the new version after every move, and once after
+    // a whole-state change (new game, load, auto-solve) completes. Listeners run in the
+    // order they were added and must not add or remove listeners themselves.
+    // Returns the id to pass to removeStateListener.
+    int addStateListener(std::function<void(uint64_t)> listener) {
+        stateListeners.emplace_back(++lastStateListenerId, std::move(listener));
+        return lastStateListenerId;
+    }
+
+    void removeStateListener(int id) {
+        stateListeners.erase(std::remove_if(stateListeners.begin(), stateListeners.end(),
+            [id](const std::pair<int, std::function<void(uint64_t)>>& entry) { return entry.first == id; }),
+            stateListeners.end());
+    }
+
+    // Invoked after every successful player action, and with a RESET record after
+    // anything that replaces the whole state
+    void setMoveRecordedCallback(std::function<void(const MoveRecord&)> callback) {
+        moveRecordedCallback = std::move(callback);
+    }
+
+    // Replays a recorded action; RESET records cannot be replayed
+    bool applyMove(const MoveRecord& record) {
+        switch (record.kind) {
+        case MoveRecord::PLACE:
+            return placeDomino(Domino(record.value1, record.value2), record.to, record.orientation);
+        case MoveRecord::REMOVE:
+            return removeDomino(record.from);
+        case MoveRecord::MOVE: {
+            Position second = record.orientation == Orientation::HORIZONTAL ?
+                Position(record.to.row, record.to.col + 1) : Position(record.to.row + 1, record.to.col);
+            return moveDomino(record.from, record.to, second);
+        }
+        case MoveRecord::HINT:
+            ++hintsUsed;
+            markStateChanged();
+            recordMove(record);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Snapshots
+    // Returns an immutable copy of the current state that other threads may read freely.
+    // Call from the thread that owns the game; repeated calls between moves share one copy.
+    SnapshotPtr snapshot() const {
+        if (!cachedSnapshot || cachedSnapshot->version != stateVersion) {
+            auto snap = std::make_shared<BoardSnapshot>();
+            snap->version = stateVersion;
+            snap->board = toCompactBoard();
+            snap->solution = solutionBoard;
+            cachedSnapshot = snap;
+        }
+        return cachedSnapshot;
+    }
+
+    // The puzzle's pieces (the solution's set once generated) with the player's placements applied
+    CompactBoard toCompactBoard() const {
+        CompactBoard board;
+        board.reset(gridSize);
+
+        const std::vector<Domino>& pool = hasSolution ? solutionDominoes : availableDominoes;
+        for (const auto& domino : pool) {
+            board.addPiece(domino.getValue1(), domino.getValue2());
+        }
+
+        for (int row = 0; row < gridSize; ++row) {
+            for (int col = 0; col < gridSize; ++col) {
+                if (dominoGrid[row][col] == -1 && grid[row][col] > 0) {
+                    board.setClue(row, col, grid[row][col]);
+                }
+            }
+        }
+
+        for (const auto& domino : placedDominoes) {
+            int index = board.findPiece(domino.getValue1(), domino.getValue2());
+            if (index < 0 || board.piece(index).isPlaced()) {
+                index = board.addPiece(domino.getValue1(), domino.getValue2());
+            }
+            if (index >= 0) {
+                Position pos = domino.getPosition();
+                board.placeUnchecked(index, pos.row, pos.col,
+                    domino.getOrientation() == Orientation::VERTICAL ? 1 : 0);
+            }
+        }
+
+        return board;
+    }
 
     // Hints
+    void setHintTimeBudget(int budgetMs) { hintTimeBudgetMs = std::max(1, budgetMs); }
+    int getHintTimeBudget() const { return hintTimeBudgetMs; }
+
+    // Solves from the player's current board within the hint budget. Reports either a
+    // placement that extends to a full solution or the earliest placed piece that is wrong.
+    SolverHint getSolverHint() const {
+        TRACE_SPAN("getSolverHint");
+        ALLOCATION_SCOPE("getSolverHint");
+        SnapshotPtr snap = snapshot();
+        PuzzleSolver solver(hintTimeBudgetMs);
+        return solver.findHint(snap->board, snap->solution.get());
+    }
+
     bool getHint(Position& pos1, Position& pos2, int& value) {
-        if (hintsUsed >= MAX_HINTS_ALLOWED || !hasSolution) {
+        TRACE_SPAN("getHint");
+        ALLOCATION_SCOPE("getHint");
+        if (hintsUsed >= MAX_HINTS_ALLOWED) {
             return false;
         }
 
+        SolverHint solved = getSolverHint();
+        if (solved.status == SolverHint::PLACEMENT) {
+            pos1 = Position(solved.move.row, solved.move.col);
+            pos2 = solved.move.vertical ? Position(pos1.row + 1, pos1.col) : Position(pos1.row, pos1.col + 1);
+            value = solved.move.value1 + solved.move.value2;
+            hintsUsed++;
+            recordMove(MoveRecord(MoveRecord::HINT));
+            return true;
+        }
+
+        // A wrong piece has to come off before any placement can help
+        if (solved.status == SolverHint::WRONG_PIECE || solved.status == SolverHint::SOLVED || !hasSolution) {
+            return false;
+        }
+
+        // Solver timed out: fall back to the stored solution
         for (const auto& solutionDomino : solutionDominoes) {
             if (usedSums.count(solutionDomino.getSum()) == 0) {
                 pos1 = solutionDomino.getPosition();
@@ -408,6 +845,7 @@ public:
                     Position(pos1.row, pos1.col + 1) : Position(pos1.row + 1, pos1.col);
                 value = solutionDomino.getSum();
                 hintsUsed++;
+                recordMove(MoveRecord(MoveRecord::HINT));
                 return true;
             }
         }
@@ -421,6 +859,8 @@ public:
             return false;
         }
 
+        StateReplacement replacing(*this);
+
         // Clear current placement
         for (auto& domino : placedDominoes) {
             domino.remove();
@@ -428,6 +868,7 @@ public:
         placedDominoes.clear();
         usedSums.clear();
         dominoGrid.assign(gridSize, std::vector<int>(gridSize, -1));
+        markStateChanged();
 
         // Place solution dominoes
         for (const auto& solutionDomino : solutionDominoes) {
@@ -440,94 +881,205 @@ public:
     }
 
     // Save/Load functionality
+    // A save is a 16-byte header (magic, format version, flags, payload length, payload CRC)
+    // followed by a bit-packed payload, see serialize(). Files without the magic are read
+    // with the original field-by-field layout.
     bool saveGame(const std::string& filename) const {
-        std::ofstream file(filename, std::ios::binary);
+        TRACE_SPAN("saveGame");
+        ALLOCATION_SCOPE("saveGame");
+        std::vector<uint8_t> buffer = serialize();
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
         if (!file.is_open()) {
             return false;
         }
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        return file.good();
+    }
 
-        // Save basic game state
-        file.write(reinterpret_cast<const char*>(&gridSize), sizeof(gridSize));
-        file.write(reinterpret_cast<const char*>(&currentDifficulty), sizeof(currentDifficulty));
-        file.write(reinterpret_cast<const char*>(&useExtendedSet), sizeof(useExtendedSet));
-        file.write(reinterpret_cast<const char*>(&hintsUsed), sizeof(hintsUsed));
-        file.write(reinterpret_cast<const char*>(&movesCount), sizeof(movesCount));
+    // Decodes straight from a mapping of the file, without an intermediate copy
+    bool loadGame(const std::string& filename, LoadMode mode = LoadMode::VALIDATED) {
+        TRACE_SPAN("loadGame");
+        ALLOCATION_SCOPE("loadGame");
+        MappedFile file;
+        if (!file.open(filename)) {
+            return false;
+        }
 
-        // Save grid
-        for (const auto& row : grid) {
-            for (int cell : row) {
-                file.write(reinterpret_cast<const char*>(&cell), sizeof(cell));
-            }
+        if (file.size() >= SAVE_HEADER_SIZE && LittleEndian::get32(file.data()) == SAVE_MAGIC) {
+            return deserialize(file.data(), file.size(), mode);
         }
+        return loadLegacyGame(file.data(), file.size(), mode);
+    }
 
-        // Save placed dominoes
-        size_t placedCount = placedDominoes.size();
-        file.write(reinterpret_cast<const char*>(&placedCount), sizeof(placedCount));
-        for (const auto& domino : placedDominoes) {
-            int v1 = domino.getValue1();
-            int v2 = domino.getValue2();
-            Position pos = domino.getPosition();
-            Orientation orient = domino.getOrientation();
+    // Payload fields, least significant bit first:
+    //   grid size (5), difficulty (2), hints used (8), moves (32)
+    //   every cell's clue as a nibble; 15 escapes to a following byte
+    //   placed pieces in move order: count (8), then per piece value nibbles (4 + 4)
+    //   and placement id (row * size + col) * 2 + vertical (10)
+    //   with SAVE_HAS_SOLUTION: the solution pieces the same way, grade tier (2) and score (16)
+    //   with SAVE_HAS_SEED: the puzzle's seed (64) and generator version (8); builds that
+    //   predate the flag stop reading before it
+    std::vector<uint8_t> serialize() const {
+        TRACE_SPAN("serialize");
+        ALLOCATION_SCOPE("serialize");
+        std::vector<uint8_t> buffer(SAVE_HEADER_SIZE, 0);
+        BitWriter bits(buffer);
+        bits.write(static_cast<uint32_t>(gridSize), 5);
+        bits.write(static_cast<uint32_t>(currentDifficulty), 2);
+        bits.write(static_cast<uint32_t>(std::min(hintsUsed, 255)), 8);
+        bits.write(static_cast<uint32_t>(movesCount), 32);
 
-            file.write(reinterpret_cast<const char*>(&v1), sizeof(v1));
-            file.write(reinterpret_cast<const char*>(&v2), sizeof(v2));
-            file.write(reinterpret_cast<const char*>(&pos.row), sizeof(pos.row));
-            file.write(reinterpret_cast<const char*>(&pos.col), sizeof(pos.col));
-            file.write(reinterpret_cast<const char*>(&orient), sizeof(orient));
+        for (int row = 0; row < gridSize; ++row) {
+            for (int col = 0; col < gridSize; ++col) {
+                // Covered cells show the piece's sum, which placing it again restores
+                int clue = dominoGrid[row][col] == -1 ? std::max(0, std::min(grid[row][col], 255)) : 0;
+                if (clue < 15) {
+                    bits.write(static_cast<uint32_t>(clue), 4);
+                }
+                else {
+                    bits.write(15, 4);
+                    bits.write(static_cast<uint32_t>(clue), 8);
+                }
+            }
         }
 
-        return file.good();
+        writePieces(bits, placedDominoes);
+        uint16_t flags = useExtendedSet ? SAVE_EXTENDED_SET : 0;
+        if (hasSolution) {
+            flags |= SAVE_HAS_SOLUTION;
+            writePieces(bits, solutionDominoes);
+            bits.write(static_cast<uint32_t>(puzzleGrade.tier), 2);
+            bits.write(static_cast<uint32_t>(puzzleGrade.score), 16);
+        }
+        if (hasPuzzleSeed) {
+            flags |= SAVE_HAS_SEED;
+            bits.write(static_cast<uint32_t>(puzzleSeed), 32);
+            bits.write(static_cast<uint32_t>(puzzleSeed >> 32), 32);
+            bits.write(static_cast<uint32_t>(puzzleGeneratorVersion), 8);
+        }
+        bits.flush();
+
+        uint8_t* header = buffer.data();
+        size_t payload = buffer.size() - SAVE_HEADER_SIZE;
+        LittleEndian::put32(header, SAVE_MAGIC);
+        LittleEndian::put16(header + 4, SAVE_FORMAT_VERSION);
+        LittleEndian::put16(header + 6, flags);
+        LittleEndian::put32(header + 8, static_cast<uint32_t>(payload));
+        LittleEndian::put32(header + 12, Crc32::compute(header + SAVE_HEADER_SIZE, payload));
+        return buffer;
     }
 
-    bool loadGame(const std::string& filename) {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file.is_open()) {
+    // Restores a game from serialize() output. Leaves the game untouched if the data is damaged.
+    // Only the CRC and bounds are checked in TRUSTED mode; a piece that breaks a move rule
+    // is loaded as saved.
+    bool deserialize(const uint8_t* data, size_t length, LoadMode mode = LoadMode::VALIDATED) {
+        TRACE_SPAN("deserialize");
+        ALLOCATION_SCOPE("deserialize");
+        if (length < SAVE_HEADER_SIZE || LittleEndian::get32(data) != SAVE_MAGIC ||
+            LittleEndian::get16(data + 4) != SAVE_FORMAT_VERSION) {
+            return false;
+        }
+        uint16_t flags = LittleEndian::get16(data + 6);
+        size_t payload = LittleEndian::get32(data + 8);
+        if (payload > length - SAVE_HEADER_SIZE ||
+            LittleEndian::get32(data + 12) != Crc32::compute(data + SAVE_HEADER_SIZE, payload)) {
             return false;
         }
 
-        // Load basic game state
-        file.read(reinterpret_cast<char*>(&gridSize), sizeof(gridSize));
-        file.read(reinterpret_cast<char*>(&currentDifficulty), sizeof(currentDifficulty));
-        file.read(reinterpret_cast<char*>(&useExtendedSet), sizeof(useExtendedSet));
-        file.read(reinterpret_cast<char*>(&hintsUsed), sizeof(hintsUsed));
-        file.read(reinterpret_cast<char*>(&movesCount), sizeof(movesCount));
-
-        // Initialize with new settings
-        initializeGame();
+        BitReader bits(data + SAVE_HEADER_SIZE, payload);
+        int size = static_cast<int>(bits.read(5));
+        int level = static_cast<int>(bits.read(2));
+        int hints = static_cast<int>(bits.read(8));
+        int moves = static_cast<int>(bits.read(32));
+        if (size <= 0 || size > MAX_GRID_SIZE || level > static_cast<int>(Difficulty::HARD)) {
+            return false;
+        }
 
-        // Load grid
-        grid.assign(gridSize, std::vector<int>(gridSize));
-        for (auto& row : grid) {
+        std::vector<std::vector<int>> clues(size, std::vector<int>(size, 0));
+        for (auto& row : clues) {
             for (int& cell : row) {
-                file.read(reinterpret_cast<char*>(&cell), sizeof(cell));
+                cell = static_cast<int>(bits.read(4));
+                if (cell == 15) {
+                    cell = static_cast<int>(bits.read(8));
+                }
             }
         }
 
-        // Load placed dominoes
-        size_t placedCount;
-        file.read(reinterpret_cast<char*>(&placedCount), sizeof(placedCount));
-
-        for (size_t i = 0; i < placedCount; ++i) {
-            int v1, v2;
-            Position pos;
-            Orientation orient;
+        std::vector<Domino> placed, solution;
+        bool ok = readPieces(bits, size, placed);
+        DifficultyGrade grade;
+        if (flags & SAVE_HAS_SOLUTION) {
+            ok = ok && readPieces(bits, size, solution);
+            grade.solvable = true;
+            grade.tier = static_cast<int>(bits.read(2));
+            grade.score = static_cast<int>(bits.read(16));
+        }
+        uint64_t seed = 0;
+        int generatorVersion = 0;
+        if (flags & SAVE_HAS_SEED) {
+            seed = bits.read(32);
+            seed |= static_cast<uint64_t>(bits.read(32)) << 32;
+            generatorVersion = static_cast<int>(bits.read(8));
+        }
+        if (!ok || bits.hasOverrun()) {
+            return false;
+        }
 
-            file.read(reinterpret_cast<char*>(&v1), sizeof(v1));
-            file.read(reinterpret_cast<char*>(&v2), sizeof(v2));
-            file.read(reinterpret_cast<char*>(&pos.row), sizeof(pos.row));
-            file.read(reinterpret_cast<char*>(&pos.col), sizeof(pos.col));
-            file.read(reinterpret_cast<char*>(&orient), sizeof(orient));
+        // Built on a scratch game, so a save whose pieces do not restore leaves this one as it was
+        DominoGame loaded((flags & SAVE_EXTENDED_SET) != 0, size);
+        loaded.currentDifficulty = static_cast<Difficulty>(level);
+        loaded.grid = clues;
+        loaded.hasPuzzleSeed = (flags & SAVE_HAS_SEED) != 0;
+        loaded.puzzleSeed = seed;
+        loaded.puzzleGeneratorVersion = generatorVersion;
 
-            Domino domino(v1, v2);
-            if (!placeDomino(domino, pos, orient)) {
-                return false;
+        if (!solution.empty()) {
+            loaded.solutionGrid.assign(size, std::vector<int>(size, -1));
+            for (size_t i = 0; i < solution.size(); ++i) {
+                loaded.placeDominoInSolution(solution[i], solution[i].getPosition(), solution[i].getOrientation(),
+                    static_cast<int>(i));
             }
+            loaded.hasSolution = true;
+            loaded.puzzleGrade = grade;
+            loaded.publishSolution();
         }
 
-        return file.good();
+        if (!loaded.restorePlacements(placed, mode)) {
+            return false;
+        }
+
+        loaded.hintsUsed = hints;
+        loaded.movesCount = moves;
+        adoptGame(loaded);
+        return true;
     }
 
     // Validation methods
+    // Checks every placed piece against the move rules, in the order it was placed.
+    // The separate pass for games restored with LoadMode::TRUSTED; the state is left as it was.
+    bool validatePlacements() {
+        std::vector<Domino> pieces;
+        std::vector<std::vector<int>> slots(gridSize, std::vector<int>(gridSize, -1));
+        std::unordered_set<int> sums;
+        pieces.swap(placedDominoes);
+        slots.swap(dominoGrid);
+        sums.swap(usedSums);
+
+        bool legal = true;
+        for (const auto& domino : pieces) {
+            if (!canPlaceDomino(domino, domino.getPosition(), domino.getOrientation())) {
+                legal = false;
+                break;
+            }
+            restorePlacement(domino);
+        }
+
+        placedDominoes.swap(pieces);
+        dominoGrid.swap(slots);
+        usedSums.swap(sums);
+        return legal;
+    }
+
     bool isValidSolution() const {
         if (placedDominoes.size() != availableDominoes.size()) {
             return false;
@@ -554,69 +1106,492 @@ private:
             Domino::createExtendedSet() : Domino::createStandardSet();
     }
 
-    bool generateSolution() {
-        solutionGrid.assign(gridSize, std::vector<int>(gridSize, -1));
-        solutionDominoes.clear();
+    void recordMove(const MoveRecord& record) {
+        if (moveRecordedCallback && stateReplacementDepth == 0) {
+            moveRecordedCallback(record);
+        }
+    }
 
-        std::vector<Domino> shuffledDominoes = availableDominoes;
-        std::shuffle(shuffledDominoes.begin(), shuffledDominoes.end(), rng);
+    void markStateChanged() {
+        ++stateVersion;
+        cachedSnapshot.reset();
+        if (stateReplacementDepth == 0) {
+            notifyStateChanged();
+        }
+    }
 
-        return backtrackSolution(0, shuffledDominoes);
+    void notifyStateChanged() {
+        for (const auto& entry : stateListeners) {
+            entry.second(stateVersion);
+        }
     }
 
-    bool backtrackSolution(int dominoIndex, const std::vector<Domino>& dominoes) {
-        if (dominoIndex >= static_cast<int>(dominoes.size())) {
-            hasSolution = true;
+    GenerationResult runGeneration(Difficulty difficulty) {
+        GenerationResult result;
+        currentDifficulty = difficulty;
+        initializeGame();
+        generationReport = FeasibilityReport();
+
+        for (int attempt = 0; attempt < MAX_GENERATION_ATTEMPTS && !generationBudgetSpent(); ++attempt) {
+            ++result.attempts;
+            rng = generationStreams.split();
+            if (attempt > 0) {
+                generationStats.restarted();
+            }
+            if (generationProgress) {
+                generationProgress->attempts.store(result.attempts);
+            }
+
+            // Pools that can never be laid out are rejected before any search
+            std::vector<Domino> pieces = drawPuzzlePieces(generationReport);
+            if (pieces.empty()) {
+                generationStats.pruned(SearchStats::PRUNE_FEASIBILITY);
+                break;
+            }
+
+            if (generateSolution(pieces)) {
+                generateConstraintGrid();
+                bool reachedTier = applyDifficultySettings();
+                publishSolution();
+
+                result.success = true;
+                result.metTargets = reachedTier;
+                result.timedOut = generationStopped && !generationCancel.isCancelled();
+                result.nodes = generationNodes;
+                result.search = generationStats;
+                result.grade = puzzleGrade;
+                return result;
+            }
+        }
+
+        result.infeasibility = generationReport;
+        result.nodes = generationNodes;
+        result.search = generationStats;
+        if (generationCancel.isCancelled()) {
+            result.cancelled = true;
+            initializeGame();
+            return result;
+        }
+        result.timedOut = generationStopped;
+
+        // Callers see the fallback in result.simplified and the reason in getGenerationReport()
+        result.simplified = true;
+        rng = generationStreams.split();
+        result.success = generateSimplifiedPuzzle(difficulty);
+        result.grade = puzzleGrade;
+        return result;
+    }
+
+    // Checks the generation deadline and cancellation; sticky once either has tripped
+    bool generationBudgetSpent() {
+        if (generationProgress) {
+            generationProgress->nodes.store(generationNodes);
+        }
+        if (!generationStopped &&
+            (generationCancel.isCancelled() || std::chrono::steady_clock::now() >= generationDeadline)) {
+            generationStopped = true;
+        }
+        return generationStopped;
+    }
+
+    void writePieces(BitWriter& bits, const std::vector<Domino>& pieces) const {
+        bits.write(static_cast<uint32_t>(pieces.size()), 8);
+        for (const auto& domino : pieces) {
+            Position pos = domino.getPosition();
+            int vertical = domino.getOrientation() == Orientation::VERTICAL ? 1 : 0;
+            bits.write(static_cast<uint32_t>(domino.getValue1()), 4);
+            bits.write(static_cast<uint32_t>(domino.getValue2()), 4);
+            bits.write(static_cast<uint32_t>((pos.row * gridSize + pos.col) * 2 + vertical), 10);
+        }
+    }
+
+    static bool readPieces(BitReader& bits, int size, std::vector<Domino>& pieces) {
+        int count = static_cast<int>(bits.read(8));
+        pieces.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            int v1 = static_cast<int>(bits.read(4));
+            int v2 = static_cast<int>(bits.read(4));
+            int placement = static_cast<int>(bits.read(10));
+            int cell = placement >> 1;
+            int row = cell / size, col = cell % size;
+            if (cell >= size * size || ((placement & 1) ? row + 1 : col + 1) >= size) {
+                return false;
+            }
+            Domino domino(v1, v2);
+            domino.place(Position(row, col), (placement & 1) ? Orientation::VERTICAL : Orientation::HORIZONTAL);
+            pieces.push_back(domino);
+        }
+        return true;
+    }
+
+    // Saves written before the versioned format: native-layout fields, no solution
+    bool loadLegacyGame(const uint8_t* data, size_t length, LoadMode mode) {
+        size_t offset = 0;
+        auto read = [&](void* field, size_t bytes) {
+            if (offset + bytes > length) return false;
+            std::memcpy(field, data + offset, bytes);
+            offset += bytes;
             return true;
+        };
+
+        int size = 0, hints = 0, moves = 0;
+        Difficulty level = Difficulty::EASY;
+        bool extended = false;
+        if (!read(&size, sizeof(size)) || !read(&level, sizeof(level)) || !read(&extended, sizeof(extended)) ||
+            !read(&hints, sizeof(hints)) || !read(&moves, sizeof(moves)) ||
+            size <= 0 || size > MAX_GRID_SIZE || level < Difficulty::EASY || level > Difficulty::HARD ||
+            hints < 0 || moves < 0) {
+            return false;
         }
 
-        const Domino& domino = dominoes[dominoIndex];
-        std::vector<std::pair<Position, Orientation>> possiblePlacements;
+        std::vector<std::vector<int>> clues(size, std::vector<int>(size, 0));
+        for (auto& row : clues) {
+            for (int& cell : row) {
+                if (!read(&cell, sizeof(cell))) return false;
+            }
+        }
 
-        // Generate all possible valid placements
-        for (int row = 0; row < gridSize; ++row) {
-            for (int col = 0; col < gridSize; ++col) {
-                Position pos(row, col);
+        size_t placedCount = 0;
+        if (!read(&placedCount, sizeof(placedCount))) return false;
+
+        std::vector<Domino> placed;
+        for (size_t i = 0; i < placedCount; ++i) {
+            int v1, v2;
+            Position pos;
+            Orientation orient;
+            if (!read(&v1, sizeof(v1)) || !read(&v2, sizeof(v2)) || !read(&pos.row, sizeof(pos.row)) ||
+                !read(&pos.col, sizeof(pos.col)) || !read(&orient, sizeof(orient))) {
+                return false;
+            }
+
+            Domino domino(v1, v2);
+            domino.place(pos, orient);
+            placed.push_back(domino);
+        }
+
+        // Built on a scratch game, like deserialize(), so a bad file leaves this one as it was
+        DominoGame loaded(extended, size);
+        loaded.currentDifficulty = level;
+        loaded.grid = clues;
+        if (!loaded.restorePlacements(placed, mode)) {
+            return false;
+        }
+
+        loaded.hintsUsed = hints;
+        loaded.movesCount = moves;
+        adoptGame(loaded);
+        return true;
+    }
+
+    // Takes over the board, pieces, solution and counters of a game restored from a save.
+    // Callbacks, hint budget and generator state stay with this game.
+    void adoptGame(DominoGame& loaded) {
+        StateReplacement replacing(*this);
+        gridSize = loaded.gridSize;
+        grid.swap(loaded.grid);
+        dominoGrid.swap(loaded.dominoGrid);
+        availableDominoes.swap(loaded.availableDominoes);
+        placedDominoes.swap(loaded.placedDominoes);
+        usedSums.swap(loaded.usedSums);
+
+        currentDifficulty = loaded.currentDifficulty;
+        gameCompleted = loaded.gameCompleted;
+        hintsUsed = loaded.hintsUsed;
+        movesCount = loaded.movesCount;
+        gameStartTime = loaded.gameStartTime;
+        useExtendedSet = loaded.useExtendedSet;
+
+        solutionGrid.swap(loaded.solutionGrid);
+        solutionDominoes.swap(loaded.solutionDominoes);
+        hasSolution = loaded.hasSolution;
+        solutionBoard = loaded.solutionBoard;
+        puzzleGrade = loaded.puzzleGrade;
+        hasPuzzleSeed = loaded.hasPuzzleSeed;
+        puzzleSeed = loaded.puzzleSeed;
+        puzzleGeneratorVersion = loaded.puzzleGeneratorVersion;
+
+        constraintCache.clear();
+        cacheValid = false;
+        markStateChanged();
+    }
 
-                // Try horizontal placement
-                if (canPlaceDominoInSolution(domino, pos, Orientation::HORIZONTAL)) {
-                    possiblePlacements.emplace_back(pos, Orientation::HORIZONTAL);
+    bool restorePlacements(const std::vector<Domino>& pieces, LoadMode mode) {
+        if (mode == LoadMode::VALIDATED) {
+            for (const auto& domino : pieces) {
+                if (!placeDomino(domino, domino.getPosition(), domino.getOrientation())) {
+                    return false;
                 }
+            }
+            return true;
+        }
+
+        placedDominoes.reserve(pieces.size());
+        usedSums.reserve(pieces.size());
+        for (const auto& domino : pieces) {
+            if (!restorePlacement(domino)) {
+                return false;
+            }
+        }
+
+        constraintCache.clear();
+        cacheValid = false;
+        gameCompleted = placedDominoes.size() == availableDominoes.size() && isValidSolution();
+        return true;
+    }
+
+    // Adds a placed piece to the slot map, the shown sums and the used-sum set without the
+    // move rules. Only cell bounds and overlaps are checked, which keeps the board consistent.
+    bool restorePlacement(const Domino& domino) {
+        Position first = domino.getPosition();
+        bool vertical = domino.getOrientation() == Orientation::VERTICAL;
+        Position second(first.row + (vertical ? 1 : 0), first.col + (vertical ? 0 : 1));
+        if (!first.isValidForGrid(gridSize) || !second.isValidForGrid(gridSize) ||
+            dominoGrid[first.row][first.col] != -1 || dominoGrid[second.row][second.col] != -1) {
+            return false;
+        }
+
+        int dominoId = static_cast<int>(placedDominoes.size());
+        int sum = domino.getSum();
+        placedDominoes.push_back(domino);
+        usedSums.insert(sum);
+        dominoGrid[first.row][first.col] = dominoId;
+        dominoGrid[second.row][second.col] = dominoId;
+        grid[first.row][first.col] = sum;
+        grid[second.row][second.col] = sum;
+        return true;
+    }
+
+    // The pieces one puzzle is built from, drawn from the set in random order: no doubles,
+    // which repeat their digit in their line, one piece per sum, and at most gridSize pieces,
+    // which keeps the search within a few hundred nodes on every grid size. Pieces come off
+    // the end while FeasibilityCheck rejects the rest on an empty board; the pool is empty,
+    // with the reason in `report`, if not even one piece fits.
+    std::vector<Domino> drawPuzzlePieces(FeasibilityReport& report) {
+        std::vector<Domino> shuffled = availableDominoes;
+        rng.shuffle(shuffled);
+
+        std::vector<Domino> pieces;
+        uint64_t sums = 0;
+        for (const auto& domino : shuffled) {
+            uint64_t sum = uint64_t(1) << domino.getSum();
+            if (domino.getValue1() == domino.getValue2() || (sums & sum)) {
+                continue;
+            }
+            sums |= sum;
+            pieces.push_back(domino);
+            if (static_cast<int>(pieces.size()) == gridSize) {
+                break;
+            }
+        }
+
+        while (!pieces.empty()) {
+            report = FeasibilityCheck::check(buildPoolBoard(pieces));
+            if (report.isFeasible()) {
+                break;
+            }
+            pieces.pop_back();
+        }
+        return pieces;
+    }
+
+    // The given pieces on an empty board, as the generator has to lay them out
+    CompactBoard buildPoolBoard(const std::vector<Domino>& pieces) const {
+        CompactBoard board;
+        board.reset(gridSize);
+        for (const auto& domino : pieces) {
+            board.addPiece(domino.getValue1(), domino.getValue2());
+        }
+        return board;
+    }
+
+    // Compact copy of the generated solution with the clues currently shown
+    CompactBoard buildSolutionBoard() const {
+        CompactBoard board;
+        board.reset(gridSize);
 
-                // Try vertical placement
-                if (canPlaceDominoInSolution(domino, pos, Orientation::VERTICAL)) {
-                    possiblePlacements.emplace_back(pos, Orientation::VERTICAL);
+        for (int row = 0; row < gridSize; ++row) {
+            for (int col = 0; col < gridSize; ++col) {
+                if (grid[row][col] > 0) {
+                    board.setClue(row, col, grid[row][col]);
                 }
             }
         }
 
-        // Randomize placement order
-        std::shuffle(possiblePlacements.begin(), possiblePlacements.end(), rng);
+        for (const auto& domino : solutionDominoes) {
+            int index = board.addPiece(domino.getValue1(), domino.getValue2());
+            Position pos = domino.getPosition();
+            if (index >= 0 && pos.isValid()) {
+                board.placeUnchecked(index, pos.row, pos.col,
+                    domino.getOrientation() == Orientation::VERTICAL ? 1 : 0);
+            }
+        }
+        return board;
+    }
+
+    // Freezes the generated solution so snapshots can share it. The player gets the
+    // solution's pieces to place, so a game is complete once all of them are down.
+    void publishSolution() {
+        availableDominoes.clear();
+        for (const auto& domino : solutionDominoes) {
+            if (domino.getPosition().isValid()) {
+                Domino piece = domino;
+                piece.remove();
+                availableDominoes.push_back(piece);
+            }
+        }
+        solutionBoard = std::make_shared<const CompactBoard>(buildSolutionBoard());
+        markStateChanged();
+    }
+
+    // Lays out `pieces` in the order given
+    bool generateSolution(const std::vector<Domino>& pieces) {
+        TRACE_SPAN("generateSolution");
+        solutionGrid.assign(gridSize, std::vector<int>(gridSize, -1));
+        solutionDominoes.clear();
+
+        beginSolutionSearch(pieces);
+        return stepSolutionSearch(UINT64_MAX) == SearchStep::FOUND;
+    }
 
-        // Try each possible placement
-        for (const auto& placement : possiblePlacements) {
-            Position pos = placement.first;
-            Orientation orient = placement.second;
+    void beginSolutionSearch(const std::vector<Domino>& dominoes) {
+        searchDominoes = dominoes;
+        uint32_t placements = static_cast<uint32_t>(gridSize * gridSize * 2);
+        placementOrders.resize(dominoes.size());
+        for (LazyPermutation& order : placementOrders) {
+            if (order.size() != placements) {
+                order.resize(placements);
+            }
+        }
+        solutionFrames.resize(dominoes.size() + 1);
+        searchDepth = 0;
+        searchEntering = true;
+    }
 
-            placeDominoInSolution(domino, pos, orient, dominoIndex);
+    // Depth-first search for a layout of searchDominoes, one piece per depth, on an
+    // explicit stack. Enters at most `nodeBudget` nodes and returns RUNNING if that
+    // leaves the search unfinished; the next call carries on where this one stopped.
+    // STOPPED means the generation budget ran out or was cancelled, and clears the board.
+    SearchStep stepSolutionSearch(uint64_t nodeBudget) {
+        int pieceCount = static_cast<int>(searchDominoes.size());
+        uint64_t entered = 0;
+        for (;;) {
+            if (searchEntering) {
+                if (entered == nodeBudget) {
+                    return SearchStep::RUNNING;
+                }
+                ++entered;
+                searchEntering = false;
+                if (generationStopped ||
+                    (++generationNodes % GENERATION_CHECK_INTERVAL == 0 && generationBudgetSpent())) {
+                    abandonSolutionSearch();
+                    return SearchStep::STOPPED;
+                }
+                generationStats.visit(searchDepth);
 
-            if (checkRowColumnUniquenessForPlacement(pos, orient, domino)) {
-                if (backtrackSolution(dominoIndex + 1, dominoes)) {
-                    return true;
+                if (searchDepth >= pieceCount) {
+                    hasSolution = true;
+                    return SearchStep::FOUND;
                 }
+                placementOrders[searchDepth].begin();
+                solutionFrames[searchDepth].placed = false;
+            }
+
+            // Back from a subtree that failed: take its piece off and draw the next candidate
+            SolutionFrame& frame = solutionFrames[searchDepth];
+            const Domino& domino = searchDominoes[searchDepth];
+            if (frame.placed) {
+                generationStats.backtracked();
+                liftSolutionPlacement(frame.placement);
+                frame.placed = false;
             }
 
-            removeDominoFromSolution(pos, orient);
+            // Visit the placements in random order; only the ones drawn before a solution
+            // turns up are checked
+            LazyPermutation& order = placementOrders[searchDepth];
+            uint32_t placement;
+            while (order.next(rng, placement)) {
+                Position pos = placementPosition(placement);
+                Orientation orient = placementOrientation(placement);
+                if (!canPlaceDominoInSolution(domino, pos, orient)) {
+                    recordSolutionPrune(pos, orient);
+                    continue;
+                }
+
+                // Lines are checked before the piece goes down, so a rejected candidate never touches the grid
+                SearchStats::PruneRule line = SearchStats::PRUNE_ROW_DIGIT;
+                if (!checkRowColumnUniquenessForPlacement(pos, orient, domino, &line)) {
+                    generationStats.pruned(line);
+                    continue;
+                }
+
+                placeDominoInSolution(domino, pos, orient, searchDepth);
+                generationStats.tried();
+                frame.placement = placement;
+                frame.placed = true;
+                break;
+            }
+
+            if (frame.placed) {
+                ++searchDepth;
+                searchEntering = true;
+            }
+            else if (searchDepth == 0) {
+                return SearchStep::EXHAUSTED;
+            }
+            else {
+                --searchDepth;
+            }
         }
+    }
 
-        return false;
+    // Takes every piece of the current path off the solution grid
+    void abandonSolutionSearch() {
+        for (int depth = std::min(searchDepth, static_cast<int>(searchDominoes.size()) - 1); depth >= 0; --depth) {
+            if (solutionFrames[depth].placed) {
+                liftSolutionPlacement(solutionFrames[depth].placement);
+                solutionFrames[depth].placed = false;
+            }
+        }
+        searchDepth = 0;
+        searchEntering = false;
+    }
+
+    // A copy of where a suspended search stands, see SolutionFrontier
+    SolutionFrontier solutionFrontier() const {
+        SolutionFrontier frontier;
+        int pieceCount = static_cast<int>(searchDominoes.size());
+        int openDepth = std::min(searchDepth + (searchEntering ? 0 : 1), pieceCount);
+        for (int depth = 0; depth < openDepth; ++depth) {
+            const LazyPermutation& order = placementOrders[depth];
+            if (frontier.stealDepth < 0 && order.drawnCount() < order.size()) {
+                frontier.stealDepth = depth;
+                order.remaining(frontier.untried);
+            }
+            if (solutionFrames[depth].placed) {
+                frontier.path.push_back(solutionFrames[depth].placement);
+            }
+        }
+        return frontier;
+    }
+
+    Position placementPosition(uint32_t placement) const {
+        int cell = static_cast<int>(placement >> 1);
+        return Position(cell / gridSize, cell % gridSize);
+    }
+
+    static Orientation placementOrientation(uint32_t placement) {
+        return (placement & 1) ? Orientation::VERTICAL : Orientation::HORIZONTAL;
+    }
+
+    void liftSolutionPlacement(uint32_t placement) {
+        removeDominoFromSolution(placementPosition(placement), placementOrientation(placement));
     }
 
     bool generateSimplifiedPuzzle(Difficulty difficulty) {
         initializeGame();
 
-        std::vector<Domino> shuffledDominoes = availableDominoes;
-        std::shuffle(shuffledDominoes.begin(), shuffledDominoes.end(), rng);
+        FeasibilityReport report;
+        std::vector<Domino> shuffledDominoes = drawPuzzlePieces(report);
 
         solutionGrid.assign(gridSize, std::vector<int>(gridSize, -1));
         solutionDominoes.clear();
@@ -642,10 +1617,11 @@ private:
             }
         }
 
-        if (dominoIndex >= availableDominoes.size() / 2) {
+        if (dominoIndex > 0 && dominoIndex >= static_cast<int>(shuffledDominoes.size()) / 2) {
             hasSolution = true;
             generateConstraintGrid();
             applyDifficultySettings();
+            publishSolution();
             return true;
         }
 
@@ -653,6 +1629,7 @@ private:
     }
 
     bool canPlaceDomino(const Domino& domino, Position position, Orientation orientation) const {
+        ZERO_ALLOCATION_SCOPE("canPlaceDomino");
         if (!position.isValidForGrid(gridSize)) return false;
 
         Position secondPos = (orientation == Orientation::HORIZONTAL) ?
@@ -675,6 +1652,21 @@ private:
             !wouldTouchOtherDominoes(position, orientation);
     }
 
+    // Attributes a candidate canPlaceDominoInSolution turned down to a cell or a neighbour
+    void recordSolutionPrune(Position pos, Orientation orient) {
+#if DOMINO_SEARCH_STATS
+        Position second = orient == Orientation::HORIZONTAL ? Position(pos.row, pos.col + 1) : Position(pos.row + 1, pos.col);
+        if (!second.isValidForGrid(gridSize)) {
+            return;     // off the board: not a candidate at all
+        }
+        bool occupied = solutionGrid[pos.row][pos.col] != -1 || solutionGrid[second.row][second.col] != -1;
+        generationStats.pruned(occupied ? SearchStats::PRUNE_OCCUPIED : SearchStats::PRUNE_TOUCH);
+#else
+        (void)pos;
+        (void)orient;
+#endif
+    }
+
     bool canPlaceDominoInSolution(const Domino& domino, Position pos, Orientation orient) const {
         if (orient == Orientation::HORIZONTAL) {
             if (pos.col + 1 >= gridSize) return false;
@@ -691,72 +1683,25 @@ private:
     }
 
     bool touchesOtherDominoes(Position pos, Orientation orient) const {
-        std::vector<Position> checkPositions;
-
-        if (orient == Orientation::HORIZONTAL) {
-            // Check all positions around the horizontal domino (pos and pos+1 horizontally)
-            for (int dr = -1; dr <= 1; ++dr) {
-                for (int dc = -1; dc <= 2; ++dc) {
-                    // Skip the domino's own positions
-                    if (dr == 0 && (dc == 0 || dc == 1)) continue;
-                    checkPositions.emplace_back(pos.row + dr, pos.col + dc);
-                }
-            }
-        }
-        else {
-            // Check all positions around the vertical domino (pos and pos+1 vertically)
-            for (int dr = -1; dr <= 2; ++dr) {
-                for (int dc = -1; dc <= 1; ++dc) {
-                    // Skip the domino's own positions
-                    if (dc == 0 && (dr == 0 || dr == 1)) continue;
-                    checkPositions.emplace_back(pos.row + dr, pos.col + dc);
-                }
-            }
-        }
-
-        for (const auto& checkPos : checkPositions) {
-            if (checkPos.isValidForGrid(gridSize)) {
-                if (solutionGrid[checkPos.row][checkPos.col] != -1) {
-                    return true;
-                }
-            }
-        }
-
-        return false;
+        return ringOccupied(solutionGrid, pos, orient);
     }
 
     bool wouldTouchOtherDominoes(Position position, Orientation orientation) const {
-        std::vector<Position> checkPositions;
-
-        if (orientation == Orientation::HORIZONTAL) {
-            // Check all positions around the horizontal domino
-            for (int dr = -1; dr <= 1; ++dr) {
-                for (int dc = -1; dc <= 2; ++dc) {
-                    // Skip the domino's own positions
-                    if (dr == 0 && (dc == 0 || dc == 1)) continue;
-                    checkPositions.emplace_back(position.row + dr, position.col + dc);
-                }
-            }
-        }
-        else {
-            // Check all positions around the vertical domino
-            for (int dr = -1; dr <= 2; ++dr) {
-                for (int dc = -1; dc <= 1; ++dc) {
-                    // Skip the domino's own positions
-                    if (dc == 0 && (dr == 0 || dr == 1)) continue;
-                    checkPositions.emplace_back(position.row + dr, position.col + dc);
-                }
-            }
-        }
+        return ringOccupied(dominoGrid, position, orientation);
+    }
 
-        for (const auto& checkPos : checkPositions) {
-            if (checkPos.isValidForGrid(gridSize)) {
-                if (dominoGrid[checkPos.row][checkPos.col] != -1) {
+    // True if a piece sits in the ring of cells around the domino; its own two cells are skipped
+    bool ringOccupied(const std::vector<std::vector<int>>& owners, Position position, Orientation orientation) const {
+        int lastRow = position.row + (orientation == Orientation::VERTICAL ? 1 : 0);
+        int lastCol = position.col + (orientation == Orientation::HORIZONTAL ? 1 : 0);
+        for (int row = std::max(0, position.row - 1); row <= std::min(gridSize - 1, lastRow + 1); ++row) {
+            for (int col = std::max(0, position.col - 1); col <= std::min(gridSize - 1, lastCol + 1); ++col) {
+                bool own = row >= position.row && row <= lastRow && col >= position.col && col <= lastCol;
+                if (!own && owners[row][col] != -1) {
                     return true;
                 }
             }
         }
-
         return false;
     }
 
@@ -791,6 +1736,7 @@ private:
     }
 
     void generateConstraintGrid() {
+        TRACE_SPAN("generateConstraintGrid");
         grid.assign(gridSize, std::vector<int>(gridSize, 0));
 
         for (int row = 0; row < gridSize; ++row) {
@@ -846,7 +1792,63 @@ private:
         return sum;
     }
 
-    void applyDifficultySettings() {
+    // Hides clues one at a time, keeping each removal only while the graded difficulty
+    // stays within the requested tier, until the grade reaches the middle of that tier.
+    // Stops early when the generation budget runs out. Returns true if the tier was reached.
+    bool applyDifficultySettings() {
+        TRACE_SPAN("applyDifficultySettings");
+        int targetTier = static_cast<int>(currentDifficulty);
+        int targetScore = DifficultyGrader::targetScore(targetTier);
+
+        CompactBoard solution = buildSolutionBoard();
+        CompactBoard puzzle = solution;
+        for (int i = 0; i < puzzle.pieceCount(); ++i) {
+            puzzle.remove(i);
+        }
+        puzzleGrade = DifficultyGrader::grade(puzzle, &solution);
+        if (!puzzleGrade.solvable) {
+            // The solution breaks the player rules, so there is no trace to grade
+            hideClueFraction();
+            return false;
+        }
+
+        std::vector<Position> constraintPositions;
+        for (int row = 0; row < gridSize; ++row) {
+            for (int col = 0; col < gridSize; ++col) {
+                if (grid[row][col] > 0) {
+                    constraintPositions.emplace_back(row, col);
+                }
+            }
+        }
+
+        rng.shuffle(constraintPositions);
+
+        for (const Position& pos : constraintPositions) {
+            if (puzzleGrade.score >= targetScore || generationBudgetSpent()) {
+                break;
+            }
+
+            int clue = grid[pos.row][pos.col];
+            puzzle.setClue(pos.row, pos.col, 0);
+            solution.setClue(pos.row, pos.col, 0);
+
+            DifficultyGrade grade = DifficultyGrader::grade(puzzle, &solution);
+            if (grade.solvable && grade.tier <= targetTier) {
+                grid[pos.row][pos.col] = 0;
+                puzzleGrade = grade;
+            }
+            else {
+                puzzle.setClue(pos.row, pos.col, clue);
+                solution.setClue(pos.row, pos.col, clue);
+            }
+        }
+
+        return puzzleGrade.tier == targetTier &&
+            (puzzleGrade.score >= targetScore || targetTier == static_cast<int>(Difficulty::EASY));
+    }
+
+    // Fallback for solutions the grader cannot follow: hide a fixed share of the clue cells
+    void hideClueFraction() {
         int cellsToHide = 0;
         switch (currentDifficulty) {
         case Difficulty::EASY:
@@ -869,7 +1871,7 @@ private:
             }
         }
 
-        std::shuffle(constraintPositions.begin(), constraintPositions.end(), rng);
+        rng.shuffle(constraintPositions);
 
         for (int i = 0; i < std::min(cellsToHide, static_cast<int>(constraintPositions.size())); ++i) {
             Position pos = constraintPositions[i];
@@ -878,109 +1880,73 @@ private:
     }
 
     bool wouldMaintainRowColumnUniqueness(const Domino& domino, Position position, Orientation orientation) const {
-        std::unordered_set<int> affectedRows;
-        std::unordered_set<int> affectedCols;
+        uint32_t digits = (1u << domino.getValue1()) | (1u << domino.getValue2());
+        int lastRow = position.row + (orientation == Orientation::VERTICAL ? 1 : 0);
+        int lastCol = position.col + (orientation == Orientation::HORIZONTAL ? 1 : 0);
 
-        if (orientation == Orientation::HORIZONTAL) {
-            affectedRows.insert(position.row);
-            affectedCols.insert(position.col);
-            affectedCols.insert(position.col + 1);
-        }
-        else {
-            affectedRows.insert(position.row);
-            affectedRows.insert(position.row + 1);
-            affectedCols.insert(position.col);
-        }
-
-        // Check row uniqueness
-        for (int row : affectedRows) {
-            std::unordered_set<int> rowDigits;
-            for (int c = 0; c < gridSize; ++c) {
-                int dominoId = dominoGrid[row][c];
-                if (dominoId != -1) {
-                    const Domino& piece = placedDominoes[dominoId];
-                    if (!rowDigits.insert(piece.getValue1()).second) return false;
-                    if (!rowDigits.insert(piece.getValue2()).second) return false;
-                }
-            }
-            // Check new domino values
-            if (rowDigits.count(domino.getValue1()) || rowDigits.count(domino.getValue2())) {
-                return false;
-            }
+        for (int row = position.row; row <= lastRow; ++row) {
+            if (!lineAccepts(dominoGrid, placedDominoes, digits, -1, row, true)) return false;
         }
-
-        // Check column uniqueness
-        for (int col : affectedCols) {
-            std::unordered_set<int> colDigits;
-            for (int r = 0; r < gridSize; ++r) {
-                int dominoId = dominoGrid[r][col];
-                if (dominoId != -1) {
-                    const Domino& piece = placedDominoes[dominoId];
-                    if (!colDigits.insert(piece.getValue1()).second) return false;
-                    if (!colDigits.insert(piece.getValue2()).second) return false;
-                }
-            }
-            // Check new domino values
-            if (colDigits.count(domino.getValue1()) || colDigits.count(domino.getValue2())) {
-                return false;
-            }
+        for (int col = position.col; col <= lastCol; ++col) {
+            if (!lineAccepts(dominoGrid, placedDominoes, digits, -1, col, false)) return false;
         }
-
         return true;
     }
 
-    bool checkRowColumnUniquenessForPlacement(Position pos, Orientation orient, const Domino& domino) const {
-        std::unordered_set<int> affectedRows;
-        std::unordered_set<int> affectedCols;
-
-        if (orient == Orientation::HORIZONTAL) {
-            affectedRows.insert(pos.row);
-            affectedCols.insert(pos.col);
-            affectedCols.insert(pos.col + 1);
-        }
-        else {
-            affectedRows.insert(pos.row);
-            affectedRows.insert(pos.row + 1);
-            affectedCols.insert(pos.col);
-        }
-
-        // Check rows
-        for (int row : affectedRows) {
-            std::unordered_set<int> rowDigits;
-            for (int c = 0; c < gridSize; ++c) {
-                int dominoId = solutionGrid[row][c];
-                if (dominoId != -1) {
-                    const Domino& piece = solutionDominoes[dominoId];
-                    if (!rowDigits.insert(piece.getValue1()).second) return false;
-                    if (!rowDigits.insert(piece.getValue2()).second) return false;
-                }
-            }
-            // Check new domino values
-            if (rowDigits.count(domino.getValue1()) || rowDigits.count(domino.getValue2())) {
-                return false;
+    // True if the line's pieces repeat no digit and share none with `digits`, the digits of
+    // the piece being judged. `owners` maps cells to indexes in `pieces`, for the player's
+    // board or the solution; cells owned by `self` are that piece's own and are skipped,
+    // so it can be judged after it went down. Digits are kept as bits, so the check
+    // allocates nothing.
+    bool lineAccepts(const std::vector<std::vector<int>>& owners, const std::vector<Domino>& pieces,
+        uint32_t digits, int self, int line, bool isRow) const {
+        uint32_t seen = 0;
+        int previous = -1;
+        for (int i = 0; i < gridSize; ++i) {
+            int dominoId = isRow ? owners[line][i] : owners[i][line];
+            // A piece lying along the line covers two neighbouring cells but contributes its digits once
+            if (dominoId == -1 || dominoId == self || dominoId == previous) {
+                previous = dominoId;
+                continue;
             }
+            previous = dominoId;
+
+            const Domino& piece = pieces[dominoId];
+            uint32_t first = 1u << piece.getValue1();
+            uint32_t second = 1u << piece.getValue2();
+            if (seen & first) return false;
+            seen |= first;
+            if (seen & second) return false;
+            seen |= second;
         }
+        return (seen & digits) == 0;
+    }
 
-        // Check columns
-        for (int col : affectedCols) {
-            std::unordered_set<int> colDigits;
-            for (int r = 0; r < gridSize; ++r) {
-                int dominoId = solutionGrid[r][col];
-                if (dominoId != -1) {
-                    const Domino& piece = solutionDominoes[dominoId];
-                    if (!colDigits.insert(piece.getValue1()).second) return false;
-                    if (!colDigits.insert(piece.getValue2()).second) return false;
-                }
+    // Judges `domino` at pos against the other pieces on the solution grid, before or after it
+    // is placed there. Reports the kind of line that repeats a digit through `conflict`, when given.
+    bool checkRowColumnUniquenessForPlacement(Position pos, Orientation orient, const Domino& domino,
+        SearchStats::PruneRule* conflict = nullptr) const {
+        uint32_t digits = (1u << domino.getValue1()) | (1u << domino.getValue2());
+        int self = solutionGrid[pos.row][pos.col];     // -1 unless the piece is already down
+        bool vertical = orient == Orientation::VERTICAL;
+        for (int row = pos.row; row <= pos.row + (vertical ? 1 : 0); ++row) {
+            if (!lineAccepts(solutionGrid, solutionDominoes, digits, self, row, true)) {
+                return lineConflict(conflict, SearchStats::PRUNE_ROW_DIGIT);
             }
-            // Check new domino values
-            if (colDigits.count(domino.getValue1()) || colDigits.count(domino.getValue2())) {
-                return false;
+        }
+        for (int col = pos.col; col <= pos.col + (vertical ? 0 : 1); ++col) {
+            if (!lineAccepts(solutionGrid, solutionDominoes, digits, self, col, false)) {
+                return lineConflict(conflict, SearchStats::PRUNE_COLUMN_DIGIT);
             }
         }
-
         return true;
     }
 
+    static bool lineConflict(SearchStats::PruneRule* conflict, SearchStats::PruneRule rule) {
+        if (conflict) *conflict = rule;
+        return false;
+    }
+
     void updateDominoIds() {
         std::vector<std::vector<int>> newDominoGrid(gridSize, std::vector<int>(gridSize, -1));
 
@@ -994,55 +1960,12 @@ private:
         dominoGrid = std::move(newDominoGrid);
     }
 
+    // The finished board obeys the move rule: no line repeats a digit among the pieces touching it
     bool checkRowColumnUniqueness() const {
-        // Check row uniqueness
-        for (int row = 0; row < gridSize; ++row) {
-            std::unordered_set<int> rowDigits;
-
-            for (int col = 0; col < gridSize; ++col) {
-                int dominoId = dominoGrid[row][col];
-                if (dominoId != -1 && dominoId < static_cast<int>(placedDominoes.size())) {
-                    const Domino& domino = placedDominoes[dominoId];
-
-                    // Check if this is the first cell of the domino (to avoid counting twice)
-                    Position dominoPos = domino.getPosition();
-                    if (row == dominoPos.row && col == dominoPos.col) {
-                        // Add both values from the domino
-                        if (!rowDigits.insert(domino.getValue1()).second) {
-                            return false; // Duplicate found in row
-                        }
-                        if (!rowDigits.insert(domino.getValue2()).second) {
-                            return false; // Duplicate found in row
-                        }
-                    }
-                }
-            }
+        for (int line = 0; line < gridSize; ++line) {
+            if (!lineAccepts(dominoGrid, placedDominoes, 0, -1, line, true) ||
+                !lineAccepts(dominoGrid, placedDominoes, 0, -1, line, false)) return false;
         }
-
-        // Check column uniqueness
-        for (int col = 0; col < gridSize; ++col) {
-            std::unordered_set<int> colDigits;
-
-            for (int row = 0; row < gridSize; ++row) {
-                int dominoId = dominoGrid[row][col];
-                if (dominoId != -1 && dominoId < static_cast<int>(placedDominoes.size())) {
-                    const Domino& domino = placedDominoes[dominoId];
-
-                    // Check if this is the first cell of the domino (to avoid counting twice)
-                    Position dominoPos = domino.getPosition();
-                    if (row == dominoPos.row && col == dominoPos.col) {
-                        // Add both values from the domino
-                        if (!colDigits.insert(domino.getValue1()).second) {
-                            return false; // Duplicate found in column
-                        }
-                        if (!colDigits.insert(domino.getValue2()).second) {
-                            return false; // Duplicate found in column
-                        }
-                    }
-                }
-            }
-        }
-
-        return true; // All rows and columns have unique digits
+        return true;
     }
 };
\ No newline at end of file
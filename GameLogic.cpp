@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "GameLogic.h"
+#include "RandomStream.h"
 #include <algorithm>
 #include <random>
 #include <chrono>
@@ -24,6 +25,13 @@ GameState* GameLogic::GetGameState() const
 }
 
 bool GameLogic::GeneratePuzzle(Difficulty difficulty)
+{
+    std::random_device device;
+    unsigned seed = device() ^ static_cast<unsigned>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return GeneratePuzzle(difficulty, seed);
+}
+
+bool GameLogic::GeneratePuzzle(Difficulty difficulty, unsigned seed)
 {
     if (!m_gameState) return false;
 
@@ -32,7 +40,7 @@ bool GameLogic::GeneratePuzzle(Difficulty difficulty)
 
     // Initialize the grid and dominoes
     InitializeGrid();
-    GenerateDominoes();
+    GenerateDominoes(seed);
 
     // Create puzzle based on difficulty
     switch (difficulty)
@@ -51,6 +59,7 @@ bool GameLogic::GeneratePuzzle(Difficulty difficulty)
     // Record game start time
     m_gameState->gameStartTime = GetTickCount();
     m_gameState->currentDifficulty = difficulty;
+    m_gameState->puzzleSeed = seed;
 
     return true;
 }
@@ -282,7 +291,7 @@ void GameLogic::InitializeGrid()
     }
 }
 
-void GameLogic::GenerateDominoes()
+void GameLogic::GenerateDominoes(unsigned seed)
 {
     if (!m_gameState) return;
 
@@ -301,17 +310,16 @@ void GameLogic::GenerateDominoes()
         }
     }
 
-    ShuffleDominoes();
+    ShuffleDominoes(seed);
 }
 
-void GameLogic::ShuffleDominoes()
+void GameLogic::ShuffleDominoes(unsigned seed)
 {
     if (!m_gameState) return;
 
-    // Shuffle the dominoes
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::shuffle(m_gameState->availableDominoes.begin(), m_gameState->availableDominoes.end(),
-        std::default_random_engine(seed));
+    // Shuffle the dominoes; a seed deals the same set with every compiler
+    RandomStream rng(seed);
+    rng.shuffle(m_gameState->availableDominoes);
 }
 
 void GameLogic::CreateEasyPuzzle()
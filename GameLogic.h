@@ -18,7 +18,11 @@ public:
     GameState* GetGameState() const;
 
     // Game control methods
-    bool GeneratePuzzle(Difficulty difficulty);
+    // Deals a shuffled piece set on the caller's thread without any search, so it returns in
+    // the same short time on every difficulty. It is not DominoGame::generateNewGame and does
+    // not take that path's deadline or cancellation.
+    bool GeneratePuzzle(Difficulty difficulty);                 // fresh seed
+    bool GeneratePuzzle(Difficulty difficulty, unsigned seed);  // same seed, same dominoes
     void ResetGame();
     bool PlaceDomino(int row, int col);
     bool RemoveDomino(int row, int col);
@@ -33,8 +37,8 @@ public:
 private:
     // Helper methods
     void InitializeGrid();
-    void GenerateDominoes();
-    void ShuffleDominoes();
+    void GenerateDominoes(unsigned seed);
+    void ShuffleDominoes(unsigned seed);
     bool SolvePuzzle();
     void ClearPlacedDominoes();
     int GetNextAvailableDominoId();
@@ -60,6 +60,7 @@ public:
     int selectedDomino;                      // Index of currently selected domino (-1 = none)
     Orientation currentOrientation;          // Current orientation for placing dominoes
     Difficulty currentDifficulty;            // Current game difficulty
+    unsigned puzzleSeed;                     // Seed that GameLogic::GeneratePuzzle deals this set from
 
     // Game statistics
     DWORD gameStartTime;                     // Game start time (from GetTickCount())
@@ -83,6 +84,7 @@ public:
         selectedDomino = -1;
         currentOrientation = Orientation::HORIZONTAL;
         currentDifficulty = Difficulty::EASY;
+        puzzleSeed = 0;
         gameStartTime = GetTickCount();
         hintsUsed = 0;
         gameWon = false;
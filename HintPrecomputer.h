@@ -0,0 +1,125 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "CompactBoard.h"
+#include "CancellationToken.h"
+#include "PuzzleSolver.h"
+#include "TraceRecorder.h"
+
+// Recomputes the next hint on a worker thread whenever the game state
+// changes. Each job runs against an immutable snapshot; scheduling a newer
+// snapshot cancels the job in flight, and results are only kept when their
+// state version is still the latest one scheduled.
+class HintPrecomputer {
+public:
+    using HintFunction = std::function<SolverHint(const BoardSnapshot&, const CancellationToken&)>;
+
+private:
+    HintFunction compute;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    SnapshotPtr pending;
+    CancellationToken running;
+    uint64_t runningVersion;
+    uint64_t scheduledVersion;
+    bool stopping;
+
+    // Latest finished result
+    bool hasResult;
+    uint64_t resultVersion;
+    SolverHint result;
+
+    std::thread worker;
+
+public:
+    explicit HintPrecomputer(HintFunction fn)
+        : compute(std::move(fn)), runningVersion(0), scheduledVersion(0), stopping(false),
+        hasResult(false), resultVersion(0) {
+        worker = std::thread(&HintPrecomputer::workerLoop, this);
+    }
+
+    ~HintPrecomputer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            pending.reset();
+            running.cancel();
+        }
+        wake.notify_one();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    HintPrecomputer(const HintPrecomputer&) = delete;
+    HintPrecomputer& operator=(const HintPrecomputer&) = delete;
+
+    // Queue a snapshot for analysis, abandoning any older job
+    void schedule(SnapshotPtr snap) {
+        if (!snap) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t version = snap->version;
+            bool alreadyQueued = pending && pending->version == version;
+            bool alreadyRunning = runningVersion == version && !running.isCancelled();
+            bool alreadyDone = hasResult && resultVersion == version;
+            if (alreadyQueued || alreadyRunning || alreadyDone) {
+                return;
+            }
+            running.cancel();
+            scheduledVersion = snap->version;
+            pending = std::move(snap);
+        }
+        wake.notify_one();
+    }
+
+    // Drop queued and running work without scheduling anything new
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.reset();
+        running.cancel();
+    }
+
+    // Copies out the cached result if it was computed for this exact state version
+    bool tryGetResult(uint64_t version, SolverHint& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!hasResult || resultVersion != version) {
+            return false;
+        }
+        out = result;
+        return true;
+    }
+
+private:
+    void workerLoop() {
+        TraceRecorder::instance().setThreadName("Hint precomputer");
+        for (;;) {
+            SnapshotPtr job;
+            CancellationToken token;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || pending; });
+                if (stopping) return;
+
+                job = std::move(pending);
+                pending.reset();
+                token = CancellationToken::create();
+                running = token;
+                runningVersion = job->version;
+            }
+
+            SolverHint hint = compute(*job, token);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            runningVersion = 0;
+            if (!token.isCancelled() && job->version == scheduledVersion) {
+                result = hint;
+                resultVersion = job->version;
+                hasResult = true;
+            }
+        }
+    }
+};
@@ -2,9 +2,14 @@
 #include <vector>
 #include <map>
 #include <algorithm>
-#include <random>
 #include <set>
-#include "DominoGame.h"  // Assuming this contains the DominoGame class
+#include <memory>
+#include <atomic>
+#include "GameGrid.h"
+#include "CompactBoard.h"
+#include "DeductionEngine.h"
+#include "HintPrecomputer.h"
+#include "PuzzleSolver.h"
 
 class HintSystem {
 private:
@@ -15,65 +20,47 @@ private:
     int maxHintsAllowed;
     int hintsUsed;
 
-    // Random number generator for hint selection
-    std::mt19937 rng;
+    // Wall-clock budget for each solver-backed hint search
+    std::atomic<int> solverBudgetMs;
 
-    // Helper method to get unplaced dominoes
-    std::vector<DominoPiece> getUnplacedDominoes() const {
-        std::vector<DominoPiece> unplaced;
-        const auto& available = game.getAvailableDominoes();
-        const auto& placed = game.getPlacedDominoes();
+    // Worker that recomputes the next hint after every move, and its subscription on the game
+    std::unique_ptr<HintPrecomputer> precomputer;
+    int stateListener;
 
-        std::set<DominoPiece> placedSet(placed.begin(), placed.end());
-
-        for (const auto& domino : available) {
-            if (placedSet.find(domino) == placedSet.end()) {
-                unplaced.push_back(domino);
-            }
+public:
+    explicit HintSystem(DominoGame& gameRef, int maxHints = 3, bool speculative = true)
+        : game(gameRef), maxHintsAllowed(maxHints), hintsUsed(0),
+        solverBudgetMs(PuzzleSolver::DEFAULT_TIME_BUDGET_MS), stateListener(0) {
+        if (speculative) {
+            precomputer.reset(new HintPrecomputer([this](const BoardSnapshot& snap, const CancellationToken& cancel) {
+                return computeSolverHint(snap, cancel);
+            }));
+            stateListener = game.addStateListener([this](uint64_t) { scheduleSpeculativeHint(); });
+            scheduleSpeculativeHint();
         }
-
-        return unplaced;
     }
 
-    // Helper method to calculate constraint value (since the original is private)
-    int calculateConstraintValueHelper(int row, int col) const {
-        int sum = 0;
-        std::set<int> adjacentDominoes;
-        const auto& dominoGrid = game.getDominoGrid();
-        const auto& placedDominoes = game.getPlacedDominoes();
-
-        // Check all adjacent cells
-        for (int dr = -1; dr <= 1; ++dr) {
-            for (int dc = -1; dc <= 1; ++dc) {
-                if (dr == 0 && dc == 0) continue;
-
-                int newRow = row + dr;
-                int newCol = col + dc;
-
-                if (newRow >= 0 && newRow < game.getGridSize() &&
-                    newCol >= 0 && newCol < game.getGridSize()) {
-
-                    int dominoId = dominoGrid[newRow][newCol];
-                    if (dominoId != -1 && dominoId < static_cast<int>(placedDominoes.size())) {
-                        adjacentDominoes.insert(dominoId);
-                    }
-                }
-            }
+    ~HintSystem() {
+        if (stateListener) {
+            game.removeStateListener(stateListener);
         }
+    }
 
-        for (int dominoId : adjacentDominoes) {
-            if (dominoId < static_cast<int>(placedDominoes.size())) {
-                sum += placedDominoes[dominoId].sum;
-            }
-        }
+    HintSystem(const HintSystem&) = delete;
+    HintSystem& operator=(const HintSystem&) = delete;
 
-        return sum;
+    // Start analysing the current state in the background; called automatically after each move
+    void scheduleSpeculativeHint() {
+        if (precomputer && !game.isGameCompleted()) {
+            precomputer->schedule(game.snapshot());
+        }
     }
 
-public:
-    explicit HintSystem(DominoGame& gameRef, int maxHints = 3)
-        : game(gameRef), maxHintsAllowed(maxHints), hintsUsed(0),
-        rng(std::random_device{}()) {
+    // True once the background search has finished for the current state, so the next
+    // domino hint is answered without searching
+    bool isHintReady() {
+        SolverHint ready;
+        return precomputer && precomputer->tryGetResult(game.snapshot()->version, ready);
     }
 
     // Get the number of hints remaining
@@ -91,68 +78,145 @@ public:
         hintsUsed = 0;
     }
 
+    // Millisecond budget for each solver search; applies to hints scheduled afterwards
+    void setSolverTimeBudget(int budgetMs) {
+        solverBudgetMs.store(std::max(1, budgetMs));
+    }
+
+    int getSolverTimeBudget() const {
+        return solverBudgetMs.load();
+    }
+
+    // Solver-backed analysis of a snapshot; safe to call from any thread
+    SolverHint computeSolverHint(const BoardSnapshot& snap, const CancellationToken& cancel) const {
+        TRACE_SPAN("computeSolverHint");
+        ALLOCATION_SCOPE("computeSolverHint");
+        PuzzleSolver solver(solverBudgetMs.load());
+        return solver.findHint(snap.board, snap.solution.get(), cancel);
+    }
+
+    // All legal placements of the first unplaced piece that has any.
+    // Reads only the snapshot, so it is safe to call from any thread.
+    static std::vector<CompactMove> findPlacementsForFirstPlaceablePiece(const CompactBoard& board,
+        const CancellationToken& cancel = CancellationToken()) {
+        std::vector<CompactMove> placements;
+
+        for (int index = 0; index < board.pieceCount(); ++index) {
+            const CompactPiece& piece = board.piece(index);
+            if (piece.isPlaced()) continue;
+            if (cancel.isCancelled()) return std::vector<CompactMove>();
+
+            for (int row = 0; row < board.size(); ++row) {
+                for (int col = 0; col < board.size(); ++col) {
+                    for (int vertical = 0; vertical <= 1; ++vertical) {
+                        if (board.canPlace(index, row, col, vertical)) {
+                            placements.push_back({ index, piece.value1, piece.value2, row, col, vertical });
+                        }
+                    }
+                }
+            }
+
+            // If we found valid placements for this domino, stop
+            if (!placements.empty()) {
+                break;
+            }
+        }
+
+        return placements;
+    }
+
     // Provide a hint about which domino to place next
     struct DominoHint {
-        DominoPiece domino;
+        Domino domino;
         Position position;
         Orientation orientation;
         bool isValid;
+        bool isWrongPlacement;  // the placed domino at position rules out every solution
+        bool isGuaranteed;      // the placement is known to extend to a full solution
+        DeductionRule rule;     // rule that forces the placement, NONE if it came from a search
 
         // Default constructor
-        DominoHint() : domino(1, 2), position(), orientation(Orientation::HORIZONTAL), isValid(false) {}
+        DominoHint() : domino(1, 2), position(), orientation(Orientation::HORIZONTAL), isValid(false),
+            isWrongPlacement(false), isGuaranteed(false), rule(DeductionRule::NONE) {}
 
         // Parameterized constructor
-        DominoHint(const DominoPiece& d, const Position& p, Orientation o, bool valid)
-            : domino(d), position(p), orientation(o), isValid(valid) {
+        DominoHint(const Domino& d, const Position& p, Orientation o, bool valid)
+            : domino(d), position(p), orientation(o), isValid(valid),
+            isWrongPlacement(false), isGuaranteed(false), rule(DeductionRule::NONE) {
+        }
+
+        // Built from a snapshot analysis result
+        explicit DominoHint(const CompactMove& move)
+            : domino(move.value1, move.value2), position(move.row, move.col),
+            orientation(move.vertical ? Orientation::VERTICAL : Orientation::HORIZONTAL),
+            isValid(true), isWrongPlacement(false), isGuaranteed(false), rule(DeductionRule::NONE) {
         }
     };
 
     DominoHint getNextDominoHint() {
+        TRACE_SPAN("getNextDominoHint");
+        ALLOCATION_SCOPE("getNextDominoHint");
         if (!canProvideHint()) {
             return DominoHint();
         }
 
-        // Get all unplaced dominoes
-        auto unplaced = getUnplacedDominoes();
-        if (unplaced.empty()) {
-            return DominoHint();
+        // Use the speculative result when it matches the current state, otherwise solve now
+        SnapshotPtr snap = game.snapshot();
+        SolverHint solved;
+        if (!precomputer || !precomputer->tryGetResult(snap->version, solved)) {
+            solved = computeSolverHint(*snap, CancellationToken());
         }
 
-        // Find any valid placement for the first unplaced domino
-        std::vector<std::tuple<DominoPiece, Position, Orientation>> validPlacements;
+        if (solved.status == SolverHint::WRONG_PIECE) {
+            DominoHint hint(solved.move);
+            hint.isWrongPlacement = true;
+            hintsUsed++;
+            return hint;
+        }
+        if (solved.status == SolverHint::SOLVED) {
+            return DominoHint();
+        }
 
-        for (const auto& domino : unplaced) {
-            // Check all possible positions
-            for (int row = 0; row < game.getGridSize(); ++row) {
-                for (int col = 0; col < game.getGridSize(); ++col) {
-                    Position pos(row, col);
+        // A logically forced placement can be explained to the player, so it wins over the solver's pick
+        DeductionEngine engine(snap->board);
+        Deduction forced = engine.nextForcedMove();
+        if (forced.found) {
+            DominoHint hint(forced.move);
+            hint.isGuaranteed = solved.status == SolverHint::PLACEMENT;
+            hint.rule = forced.rule;
+            hintsUsed++;
+            return hint;
+        }
 
-                    // Try horizontal
-                    if (game.canPlaceDomino(domino, pos, Orientation::HORIZONTAL)) {
-                        validPlacements.emplace_back(domino, pos, Orientation::HORIZONTAL);
-                    }
+        if (solved.status == SolverHint::PLACEMENT) {
+            DominoHint hint(solved.move);
+            hint.isGuaranteed = true;
+            hintsUsed++;
+            return hint;
+        }
 
-                    // Try vertical
-                    if (game.canPlaceDomino(domino, pos, Orientation::VERTICAL)) {
-                        validPlacements.emplace_back(domino, pos, Orientation::VERTICAL);
+        // Nothing is forced and the solver gave up: point at the most constrained piece's first option
+        if (!forced.contradiction) {
+            int piece = engine.mostConstrainedPiece();
+            if (piece >= 0 && engine.candidateCount(piece) > 0) {
+                const CompactPiece& p = engine.getBoard().piece(piece);
+                CompactMove move = { piece, p.value1, p.value2, -1, -1, 0 };
+                engine.forEachCandidate(piece, [&move](int row, int col, int vertical) {
+                    if (move.row < 0) {
+                        move.row = row;
+                        move.col = col;
+                        move.vertical = vertical;
                     }
-                }
-            }
-
-            // If we found valid placements for this domino, break
-            if (!validPlacements.empty()) {
-                break;
+                });
+                hintsUsed++;
+                return DominoHint(move);
             }
         }
 
+        auto validPlacements = findPlacementsForFirstPlaceablePiece(snap->board);
         if (!validPlacements.empty()) {
-            // Select a random valid placement
-            std::uniform_int_distribution<size_t> dist(0, validPlacements.size() - 1);
-            auto selection = validPlacements[dist(rng)];
-
             hintsUsed++;
-            return DominoHint(std::get<0>(selection), std::get<1>(selection),
-                std::get<2>(selection), true);
+            return DominoHint(validPlacements.front());
         }
 
         // No valid hints available
@@ -175,24 +239,16 @@ public:
         }
     };
 
-    ConstraintHint getConstraintHint() {
-        if (!canProvideHint()) {
-            return ConstraintHint();
-        }
-
-        // Find cells where the constraint doesn't match the actual sum
-        const auto& grid = game.getGrid();
-
-        for (int row = 0; row < game.getGridSize(); ++row) {
-            for (int col = 0; col < game.getGridSize(); ++col) {
-                Position pos(row, col);
-                int constraintValue = grid[row][col];
+    // First clue cell whose adjacent sum differs from its clue; safe to call from any thread
+    static ConstraintHint findConstraintMismatch(const CompactBoard& board) {
+        for (int row = 0; row < board.size(); ++row) {
+            for (int col = 0; col < board.size(); ++col) {
+                int constraintValue = board.getClue(row, col);
 
                 if (constraintValue > 0) {
-                    int actualSum = calculateConstraintValueHelper(row, col);
+                    int actualSum = board.adjacentSum(row, col);
                     if (actualSum != constraintValue) {
-                        hintsUsed++;
-                        return ConstraintHint(pos, constraintValue, actualSum, true);
+                        return ConstraintHint(Position(row, col), constraintValue, actualSum, true);
                     }
                 }
             }
@@ -201,6 +257,19 @@ public:
         return ConstraintHint();
     }
 
+    ConstraintHint getConstraintHint() {
+        ALLOCATION_SCOPE("getConstraintHint");
+        if (!canProvideHint()) {
+            return ConstraintHint();
+        }
+
+        ConstraintHint hint = findConstraintMismatch(game.snapshot()->board);
+        if (hint.isValid) {
+            hintsUsed++;
+        }
+        return hint;
+    }
+
     // Get a hint about the most constrained position
     struct PositionHint {
         Position position;
@@ -216,21 +285,15 @@ public:
         }
     };
 
-    PositionHint getMostConstrainedHint() {
-        if (!canProvideHint()) {
-            return PositionHint();
-        }
-
-        // Find the cell with the highest constraint value that's empty
+    // Empty cell with the highest clue; safe to call from any thread
+    static PositionHint findMostConstrained(const CompactBoard& board) {
         Position bestPos;
         int maxConstraint = -1;
-        const auto& grid = game.getGrid();
-        const auto& dominoGrid = game.getDominoGrid();
 
-        for (int row = 0; row < game.getGridSize(); ++row) {
-            for (int col = 0; col < game.getGridSize(); ++col) {
-                int constraint = grid[row][col];
-                if (constraint > maxConstraint && dominoGrid[row][col] == -1) {
+        for (int row = 0; row < board.size(); ++row) {
+            for (int col = 0; col < board.size(); ++col) {
+                int constraint = board.getClue(row, col);
+                if (constraint > maxConstraint && !board.isOccupied(row, col)) {
                     maxConstraint = constraint;
                     bestPos = Position(row, col);
                 }
@@ -238,13 +301,25 @@ public:
         }
 
         if (maxConstraint > 0) {
-            hintsUsed++;
             return PositionHint(bestPos, maxConstraint, true);
         }
 
         return PositionHint();
     }
 
+    PositionHint getMostConstrainedHint() {
+        ALLOCATION_SCOPE("getMostConstrainedHint");
+        if (!canProvideHint()) {
+            return PositionHint();
+        }
+
+        PositionHint hint = findMostConstrained(game.snapshot()->board);
+        if (hint.isValid) {
+            hintsUsed++;
+        }
+        return hint;
+    }
+
     // Get a random hint (combines different hint types)
     struct RandomHint {
         enum HintType { DOMINO_PLACEMENT, CONSTRAINT_MISMATCH, MOST_CONSTRAINED };
@@ -259,6 +334,7 @@ public:
     };
 
     RandomHint getRandomHint() {
+        ALLOCATION_SCOPE("getRandomHint");
         if (!canProvideHint()) {
             return RandomHint();
         }
@@ -301,4 +377,4 @@ public:
     void setHintsUsed(int used) {
         hintsUsed = std::max(0, std::min(used, maxHintsAllowed));
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+
+// Fixed-width little-endian field access for file formats, independent of the host byte order
+class LittleEndian {
+public:
+    static void put16(uint8_t* out, uint16_t value) {
+        out[0] = static_cast<uint8_t>(value);
+        out[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    static void put32(uint8_t* out, uint32_t value) {
+        put16(out, static_cast<uint16_t>(value));
+        put16(out + 2, static_cast<uint16_t>(value >> 16));
+    }
+
+    static void put64(uint8_t* out, uint64_t value) {
+        put32(out, static_cast<uint32_t>(value));
+        put32(out + 4, static_cast<uint32_t>(value >> 32));
+    }
+
+    static uint16_t get16(const uint8_t* in) {
+        return static_cast<uint16_t>(in[0] | (in[1] << 8));
+    }
+
+    static uint32_t get32(const uint8_t* in) {
+        return get16(in) | (static_cast<uint32_t>(get16(in + 2)) << 16);
+    }
+
+    static uint64_t get64(const uint8_t* in) {
+        return get32(in) | (static_cast<uint64_t>(get32(in + 4)) << 32);
+    }
+};
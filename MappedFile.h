@@ -0,0 +1,195 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file. The bytes stay valid until close() or
+// destruction; a zero-length file opens with a null data pointer.
+class MappedFile {
+private:
+    const uint8_t* bytes;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int descriptor;
+#endif
+
+public:
+    MappedFile() : bytes(nullptr), length(0),
+#ifdef _WIN32
+        file(INVALID_HANDLE_VALUE), mapping(nullptr)
+#else
+        descriptor(-1)
+#endif
+    {}
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(size.QuadPart);
+        if (length == 0) return true;
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            close();
+            return false;
+        }
+        bytes = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) return false;
+
+        struct stat info;
+        if (fstat(descriptor, &info) != 0) {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length == 0) return true;
+
+        void* view = mmap(nullptr, length, PROT_READ, MAP_SHARED, descriptor, 0);
+        bytes = view == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(view);
+#endif
+        if (!bytes) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) munmap(const_cast<uint8_t*>(bytes), length);
+        if (descriptor >= 0) ::close(descriptor);
+        descriptor = -1;
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    bool isOpen() const {
+#ifdef _WIN32
+        return file != INVALID_HANDLE_VALUE;
+#else
+        return descriptor >= 0;
+#endif
+    }
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// The few file system operations the standard library lacks before C++17
+class PlatformFile {
+public:
+    // Size in bytes, or -1 if the file does not exist
+    static int64_t size(const std::string& path) {
+#ifdef _WIN32
+        WIN32_FILE_ATTRIBUTE_DATA info;
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &info)) return -1;
+        return (static_cast<int64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+#else
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) return -1;
+        return static_cast<int64_t>(info.st_size);
+#endif
+    }
+
+    static bool truncate(const std::string& path, uint64_t length) {
+#ifdef _WIN32
+        int descriptor = -1;
+        if (_sopen_s(&descriptor, path.c_str(), _O_RDWR | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE) != 0) {
+            return false;
+        }
+        bool ok = _chsize_s(descriptor, static_cast<__int64>(length)) == 0;
+        _close(descriptor);
+        return ok;
+#else
+        return ::truncate(path.c_str(), static_cast<off_t>(length)) == 0;
+#endif
+    }
+
+    // fopen without the MSVC deprecation warning; null on failure
+    static FILE* openStream(const std::string& path, const char* mode) {
+#ifdef _WIN32
+        FILE* stream = nullptr;
+        return fopen_s(&stream, path.c_str(), mode) == 0 ? stream : nullptr;
+#else
+        return std::fopen(path.c_str(), mode);
+#endif
+    }
+
+    // Flushes a stdio stream through to the disk
+    static bool sync(FILE* stream) {
+        if (std::fflush(stream) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(stream)) == 0;
+#else
+        return fsync(fileno(stream)) == 0;
+#endif
+    }
+
+    // Renames over an existing file in one step, so readers see either the old or the new contents
+    static bool replace(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    static bool remove(const std::string& path) {
+        return std::remove(path.c_str()) == 0;
+    }
+
+    // Creates the directory if needed; true if it exists afterwards
+    static bool makeDirectory(const std::string& path) {
+#ifdef _WIN32
+        if (_mkdir(path.c_str()) == 0) return true;
+#else
+        if (mkdir(path.c_str(), 0755) == 0) return true;
+#endif
+        return errno == EEXIST;
+    }
+};
@@ -0,0 +1,430 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "GameGrid.h"
+#include "MappedFile.h"
+#include "LittleEndian.h"
+#include "Crc32.h"
+
+// Generated puzzles kept on disk between runs, one file per PuzzleKey and
+// generator version, e.g. "puzzles-8-easy-std-v1.cache".
+//
+// A file is a 32-byte header followed by fixed-size records, each with its own
+// CRC. Puzzles are appended at the end and taken from the end by truncating,
+// so a crash can at worst leave a torn last record; the first access after a
+// restart verifies the records through a read-only mapping and cuts the file
+// back to the last good one. Files written by other generator versions are
+// deleted on open. When the directory grows past its byte budget, whole
+// files are evicted in least-recently-used order.
+//
+// One process per directory; calls are serialised on an internal mutex.
+class PuzzleCache {
+public:
+    static const uint64_t DEFAULT_MAX_BYTES = uint64_t(16) << 20;
+    static const int FORMAT_VERSION = 1;
+
+private:
+    static const uint32_t MAGIC = 0x435A5044;     // "DPZC"
+    static const int HEADER_SIZE = 32;
+    static const int LAST_USED_OFFSET = 24;        // outside the header CRC: rewritten on every access
+    static const int GRADE_SIZE = 18;
+    static const int CLUES_OFFSET = 4 + GRADE_SIZE;
+    static const int PIECE_SIZE = 3;
+    static const int MAX_GRID_SIZE = 20;
+    static const int DIFFICULTY_COUNT = 3;
+    static const int KEY_COUNT = (MAX_GRID_SIZE + 1) * DIFFICULTY_COUNT * 2;
+
+    struct Entry {
+        bool exists;
+        bool verified;      // records CRC-checked since the cache was opened
+        uint32_t records;
+        uint64_t lastUsed;  // logical clock, higher is more recent
+
+        Entry() : exists(false), verified(false), records(0), lastUsed(0) {}
+    };
+
+    std::string directory;
+    uint64_t maxBytes;
+    std::mutex mutex;
+    Entry entries[KEY_COUNT];
+    uint64_t clock;
+
+public:
+    explicit PuzzleCache(const std::string& cacheDirectory, uint64_t byteBudget = DEFAULT_MAX_BYTES)
+        : directory(cacheDirectory), maxBytes(byteBudget), clock(0) {
+        PlatformFile::makeDirectory(directory);
+        for (int index = 0; index < KEY_COUNT; ++index) {
+            PuzzleKey key = keyAt(index);
+            if (key.gridSize == 0) continue;
+
+            for (int version = 1; version < DominoGame::GENERATOR_VERSION; ++version) {
+                PlatformFile::remove(pathFor(key, version));
+            }
+            scan(index, key);
+        }
+    }
+
+    PuzzleCache(const PuzzleCache&) = delete;
+    PuzzleCache& operator=(const PuzzleCache&) = delete;
+
+    // Appends a puzzle; false if it cannot be encoded or written, or would not fit the budget on its own
+    bool store(const GeneratedPuzzle& puzzle) {
+        PuzzleKey key = puzzle.key();
+        int index = keyIndex(key);
+        if (index < 0 || !puzzle.isValid()) return false;
+
+        std::vector<uint8_t> record(recordSize(key));
+        if (!encode(puzzle, record.data())) return false;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        verify(index, key);
+        Entry& entry = entries[index];
+        if (fileBytes(key, entry.records + 1) > maxBytes) return false;
+
+        std::string path = pathFor(key, DominoGame::GENERATOR_VERSION);
+        FILE* file = PlatformFile::openStream(path, entry.exists ? "ab" : "wb");
+        if (!file) return false;
+
+        bool ok = true;
+        if (!entry.exists) {
+            uint8_t header[HEADER_SIZE];
+            writeHeader(key, header);
+            ok = std::fwrite(header, 1, HEADER_SIZE, file) == HEADER_SIZE;
+            entry.exists = true;
+            entry.verified = true;
+            entry.records = 0;
+        }
+        ok = ok && std::fwrite(record.data(), 1, record.size(), file) == record.size();
+        ok = PlatformFile::sync(file) && ok;
+        std::fclose(file);
+
+        if (!ok) {
+            // Whatever part of the record reached the disk is cut off again
+            entry.verified = false;
+            verify(index, key);
+            return false;
+        }
+
+        ++entry.records;
+        touch(index, key);
+        evictFor(index);
+        return true;
+    }
+
+    // Removes and returns the most recently stored puzzle for the key
+    bool take(const PuzzleKey& key, GeneratedPuzzle& puzzle) {
+        int index = keyIndex(key);
+        if (index < 0) return false;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        verify(index, key);
+        Entry& entry = entries[index];
+        if (!entry.exists || entry.records == 0) return false;
+
+        std::string path = pathFor(key, DominoGame::GENERATOR_VERSION);
+        uint64_t remaining = fileBytes(key, entry.records - 1);
+        bool decoded = false;
+        {
+            MappedFile view;
+            if (view.open(path) && view.size() >= remaining + recordSize(key)) {
+                decoded = decode(key, view.data() + remaining, puzzle);
+            }
+        }
+
+        // Drop the record even if it failed to decode, so a bad one cannot block the rest
+        if (entry.records == 1) {
+            PlatformFile::remove(path);
+            entry = Entry();
+        }
+        else if (PlatformFile::truncate(path, remaining)) {
+            --entry.records;
+            touch(index, key);
+        }
+        else {
+            return false;
+        }
+        return decoded;
+    }
+
+    int count(const PuzzleKey& key) {
+        int index = keyIndex(key);
+        if (index < 0) return 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        verify(index, key);
+        return static_cast<int>(entries[index].records);
+    }
+
+    uint64_t totalBytes() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return totalBytesLocked();
+    }
+
+    const std::string& getDirectory() const { return directory; }
+    uint64_t getMaxBytes() const { return maxBytes; }
+
+    // Bytes one record takes for the key; the record count of a file is (size - 32) / recordSize
+    static size_t recordSize(const PuzzleKey& key) {
+        int n = key.gridSize;
+        return CLUES_OFFSET + n * n + pieceCapacity(key) * PIECE_SIZE;
+    }
+
+private:
+    static int keyIndex(const PuzzleKey& key) {
+        int level = static_cast<int>(key.difficulty);
+        if (key.gridSize <= 0 || key.gridSize > MAX_GRID_SIZE || level < 0 || level >= DIFFICULTY_COUNT) {
+            return -1;
+        }
+        return (key.gridSize * DIFFICULTY_COUNT + level) * 2 + (key.extendedSet ? 1 : 0);
+    }
+
+    static PuzzleKey keyAt(int index) {
+        return PuzzleKey(index / 2 / DIFFICULTY_COUNT, static_cast<Difficulty>(index / 2 % DIFFICULTY_COUNT),
+            index % 2 == 1);
+    }
+
+    // Placed pieces never exceed the cells or the piece set
+    static int pieceCapacity(const PuzzleKey& key) {
+        int maxValue = key.extendedSet ? 9 : 6;
+        int setSize = (maxValue + 1) * (maxValue + 2) / 2;
+        int cells = key.gridSize * key.gridSize / 2;
+        return cells < setSize ? cells : setSize;
+    }
+
+    static uint64_t fileBytes(const PuzzleKey& key, uint32_t records) {
+        return HEADER_SIZE + static_cast<uint64_t>(records) * recordSize(key);
+    }
+
+    std::string pathFor(const PuzzleKey& key, int generatorVersion) const {
+        static const char* const levels[DIFFICULTY_COUNT] = { "easy", "medium", "hard" };
+        return directory + "/puzzles-" + std::to_string(key.gridSize) + "-" +
+            levels[static_cast<int>(key.difficulty)] + (key.extendedSet ? "-ext" : "-std") +
+            "-v" + std::to_string(generatorVersion) + ".cache";
+    }
+
+    static void writeHeader(const PuzzleKey& key, uint8_t* header) {
+        std::fill(header, header + HEADER_SIZE, uint8_t(0));
+        LittleEndian::put32(header, MAGIC);
+        LittleEndian::put16(header + 4, FORMAT_VERSION);
+        LittleEndian::put16(header + 6, DominoGame::GENERATOR_VERSION);
+        header[8] = static_cast<uint8_t>(key.gridSize);
+        header[9] = static_cast<uint8_t>(key.difficulty);
+        header[10] = key.extendedSet ? 1 : 0;
+        LittleEndian::put32(header + 12, static_cast<uint32_t>(recordSize(key)));
+        LittleEndian::put32(header + 16, Crc32::compute(header, 16));
+    }
+
+    static bool headerMatches(const PuzzleKey& key, const uint8_t* header) {
+        uint8_t expected[HEADER_SIZE];
+        writeHeader(key, expected);
+        return std::equal(header, header + 20, expected);
+    }
+
+    // Picks up an existing file at startup without reading its records
+    void scan(int index, const PuzzleKey& key) {
+        std::string path = pathFor(key, DominoGame::GENERATOR_VERSION);
+        int64_t size = PlatformFile::size(path);
+        if (size < 0) return;
+
+        uint8_t header[HEADER_SIZE];
+        FILE* file = PlatformFile::openStream(path, "rb");
+        bool valid = file && std::fread(header, 1, HEADER_SIZE, file) == HEADER_SIZE && headerMatches(key, header);
+        if (file) std::fclose(file);
+        if (!valid) {
+            PlatformFile::remove(path);
+            return;
+        }
+
+        Entry& entry = entries[index];
+        entry.exists = true;
+        entry.records = static_cast<uint32_t>((size - HEADER_SIZE) / recordSize(key));
+        entry.lastUsed = LittleEndian::get64(header + LAST_USED_OFFSET);
+        if (entry.lastUsed > clock) clock = entry.lastUsed;
+    }
+
+    // Checks every record's CRC once per run and truncates after the last good one
+    void verify(int index, const PuzzleKey& key) {
+        Entry& entry = entries[index];
+        if (!entry.exists || entry.verified) return;
+
+        std::string path = pathFor(key, DominoGame::GENERATOR_VERSION);
+        size_t stride = recordSize(key);
+        uint32_t good = 0;
+        size_t size = 0;
+        bool headerOk = false;
+        {
+            MappedFile view;
+            if (view.open(path) && view.size() >= static_cast<size_t>(HEADER_SIZE)) {
+                size = view.size();
+                headerOk = headerMatches(key, view.data());
+                size_t records = (size - HEADER_SIZE) / stride;
+                const uint8_t* record = view.data() + HEADER_SIZE;
+                while (headerOk && good < records && recordIntact(record, stride)) {
+                    ++good;
+                    record += stride;
+                }
+            }
+        }
+
+        uint64_t intact = fileBytes(key, good);
+        if (!headerOk) {
+            PlatformFile::remove(path);
+            entry = Entry();
+            return;
+        }
+        if (size != intact && !PlatformFile::truncate(path, intact)) {
+            PlatformFile::remove(path);
+            entry = Entry();
+            return;
+        }
+        entry.records = good;
+        entry.verified = true;
+    }
+
+    static bool recordIntact(const uint8_t* record, size_t stride) {
+        return LittleEndian::get32(record) == Crc32::compute(record + 4, stride - 4);
+    }
+
+    void touch(int index, const PuzzleKey& key) {
+        Entry& entry = entries[index];
+        entry.lastUsed = ++clock;
+
+        FILE* file = PlatformFile::openStream(pathFor(key, DominoGame::GENERATOR_VERSION), "r+b");
+        if (!file) return;
+        uint8_t stamp[8];
+        LittleEndian::put64(stamp, entry.lastUsed);
+        if (std::fseek(file, LAST_USED_OFFSET, SEEK_SET) == 0) {
+            std::fwrite(stamp, 1, sizeof(stamp), file);
+        }
+        std::fclose(file);
+    }
+
+    uint64_t totalBytesLocked() const {
+        uint64_t total = 0;
+        for (int index = 0; index < KEY_COUNT; ++index) {
+            if (entries[index].exists) {
+                total += fileBytes(keyAt(index), entries[index].records);
+            }
+        }
+        return total;
+    }
+
+    // Drops least recently used files, never the one just written, until the budget holds
+    void evictFor(int keep) {
+        while (totalBytesLocked() > maxBytes) {
+            int oldest = -1;
+            for (int index = 0; index < KEY_COUNT; ++index) {
+                if (index == keep || !entries[index].exists) continue;
+                if (oldest < 0 || entries[index].lastUsed < entries[oldest].lastUsed) {
+                    oldest = index;
+                }
+            }
+            if (oldest < 0) return;
+
+            PlatformFile::remove(pathFor(keyAt(oldest), DominoGame::GENERATOR_VERSION));
+            entries[oldest] = Entry();
+        }
+    }
+
+    // Record layout: CRC of the rest, then piece count, grade, one byte per clue and
+    // three bytes per piece (values as nibbles, then row | col << 5 | vertical << 10)
+    static bool encode(const GeneratedPuzzle& puzzle, uint8_t* record) {
+        PuzzleKey key = puzzle.key();
+        int n = key.gridSize;
+        size_t stride = recordSize(key);
+        if (static_cast<int>(puzzle.solution.size()) > pieceCapacity(key) ||
+            static_cast<int>(puzzle.clues.size()) != n) {
+            return false;
+        }
+        std::fill(record, record + stride, uint8_t(0));
+
+        const DifficultyGrade& grade = puzzle.grade;
+        uint8_t* fields = record + 4;
+        fields[0] = static_cast<uint8_t>(puzzle.solution.size());
+        fields[1] = grade.solvable ? 1 : 0;
+        fields[2] = static_cast<uint8_t>(grade.tier);
+        LittleEndian::put16(fields + 4, static_cast<uint16_t>(grade.score));
+        LittleEndian::put16(fields + 6, static_cast<uint16_t>(grade.forcedSteps));
+        LittleEndian::put16(fields + 8, static_cast<uint16_t>(grade.deductionDepth));
+        LittleEndian::put16(fields + 10, static_cast<uint16_t>(grade.branches));
+        LittleEndian::put16(fields + 12, static_cast<uint16_t>(grade.branchBits * 100.0 + 0.5));
+        LittleEndian::put32(fields + 14, grade.rulesUsed);
+
+        uint8_t* clues = record + CLUES_OFFSET;
+        for (int row = 0; row < n; ++row) {
+            if (static_cast<int>(puzzle.clues[row].size()) != n) return false;
+            for (int col = 0; col < n; ++col) {
+                int clue = puzzle.clues[row][col];
+                if (clue < 0 || clue > 255) return false;
+                clues[row * n + col] = static_cast<uint8_t>(clue);
+            }
+        }
+
+        uint8_t* pieces = clues + n * n;
+        for (const auto& domino : puzzle.solution) {
+            Position pos = domino.getPosition();
+            int vertical = domino.getOrientation() == Orientation::VERTICAL ? 1 : 0;
+            if (!pos.isValidForGrid(n) || (vertical ? pos.row + 1 : pos.col + 1) >= n ||
+                domino.getValue1() < 0 || domino.getValue1() > 15 ||
+                domino.getValue2() < 0 || domino.getValue2() > 15) {
+                return false;
+            }
+            pieces[0] = static_cast<uint8_t>((domino.getValue1() << 4) | domino.getValue2());
+            LittleEndian::put16(pieces + 1, static_cast<uint16_t>(pos.row | (pos.col << 5) | (vertical << 10)));
+            pieces += PIECE_SIZE;
+        }
+
+        LittleEndian::put32(record, Crc32::compute(record + 4, stride - 4));
+        return true;
+    }
+
+    static bool decode(const PuzzleKey& key, const uint8_t* record, GeneratedPuzzle& puzzle) {
+        int n = key.gridSize;
+        if (!recordIntact(record, recordSize(key))) return false;
+
+        const uint8_t* fields = record + 4;
+        int pieceCount = fields[0];
+        if (pieceCount == 0 || pieceCount > pieceCapacity(key)) return false;
+
+        GeneratedPuzzle result;
+        result.gridSize = n;
+        result.extendedSet = key.extendedSet;
+        result.difficulty = key.difficulty;
+        result.grade.solvable = fields[1] != 0;
+        result.grade.tier = fields[2];
+        result.grade.score = LittleEndian::get16(fields + 4);
+        result.grade.forcedSteps = LittleEndian::get16(fields + 6);
+        result.grade.deductionDepth = LittleEndian::get16(fields + 8);
+        result.grade.branches = LittleEndian::get16(fields + 10);
+        result.grade.branchBits = LittleEndian::get16(fields + 12) / 100.0;
+        result.grade.rulesUsed = LittleEndian::get32(fields + 14);
+
+        const uint8_t* clues = record + CLUES_OFFSET;
+        result.clues.assign(n, std::vector<int>(n, 0));
+        for (int row = 0; row < n; ++row) {
+            for (int col = 0; col < n; ++col) {
+                result.clues[row][col] = clues[row * n + col];
+            }
+        }
+
+        const uint8_t* pieces = clues + n * n;
+        result.solution.reserve(pieceCount);
+        for (int i = 0; i < pieceCount; ++i, pieces += PIECE_SIZE) {
+            uint16_t placement = LittleEndian::get16(pieces + 1);
+            Position pos(placement & 0x1F, (placement >> 5) & 0x1F);
+            bool vertical = ((placement >> 10) & 1) != 0;
+            if (!pos.isValidForGrid(n) || (vertical ? pos.row + 1 : pos.col + 1) >= n) return false;
+
+            Domino domino(pieces[0] >> 4, pieces[0] & 0x0F);
+            domino.place(pos, vertical ? Orientation::VERTICAL : Orientation::HORIZONTAL);
+            result.solution.push_back(domino);
+        }
+
+        puzzle = std::move(result);
+        return true;
+    }
+};
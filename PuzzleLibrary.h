@@ -0,0 +1,357 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "GameGrid.h"
+#include "CompactBoard.h"
+#include "MappedFile.h"
+#include "LittleEndian.h"
+#include "Crc32.h"
+
+// Read-only bank of puzzles in one memory-mapped file.
+//
+//   header    magic, versions, section and puzzle counts, CRC of header and index
+//   index     one entry per PuzzleKey: stride, first puzzle number, count, file offset
+//   records   per section, `count` records of `stride` bytes
+//
+// A record holds the piece count, the grade tier and score, each solution piece
+// as two value nibbles plus a placement id (cell * 2 + vertical), and one bit
+// per cell marking the clues that are shown. Clue values are not stored: a
+// shown clue always equals the sum of the solution pieces around it, so it is
+// rebuilt from the placements. Opening the library checks only the header and
+// index; loading puzzle N locates its record arithmetically and decodes it
+// straight from the mapping into CompactBoards, without touching any other record.
+class PuzzleLibrary {
+public:
+    static const int FORMAT_VERSION = 1;
+
+private:
+    static const uint32_t MAGIC = 0x4C5A5044;     // "DPZL"
+    static const int HEADER_SIZE = 32;
+    static const int SECTION_SIZE = 24;
+    static const int RECORD_FIELDS = 4;           // piece count, tier, score
+    static const int PIECE_SIZE = 3;
+
+    struct Section {
+        PuzzleKey key;
+        uint32_t stride;
+        uint32_t first;
+        uint32_t count;
+        uint64_t offset;
+    };
+
+    MappedFile file;
+    std::vector<Section> sections;
+    uint32_t puzzleCount;
+
+public:
+    PuzzleLibrary() : puzzleCount(0) {}
+
+    PuzzleLibrary(const PuzzleLibrary&) = delete;
+    PuzzleLibrary& operator=(const PuzzleLibrary&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        if (!file.open(path) || file.size() < static_cast<size_t>(HEADER_SIZE)) {
+            close();
+            return false;
+        }
+
+        const uint8_t* header = file.data();
+        uint32_t sectionCount = LittleEndian::get32(header + 8);
+        size_t indexEnd = HEADER_SIZE + static_cast<size_t>(sectionCount) * SECTION_SIZE;
+        if (LittleEndian::get32(header) != MAGIC || LittleEndian::get16(header + 4) != FORMAT_VERSION ||
+            indexEnd > file.size() ||
+            LittleEndian::get32(header + 16) != indexCrc(header, indexEnd)) {
+            close();
+            return false;
+        }
+
+        puzzleCount = LittleEndian::get32(header + 12);
+        uint32_t expectedFirst = 0;
+        for (uint32_t i = 0; i < sectionCount; ++i) {
+            const uint8_t* entry = header + HEADER_SIZE + i * SECTION_SIZE;
+            Section section;
+            section.key = PuzzleKey(entry[0], static_cast<Difficulty>(entry[1]), entry[2] != 0);
+            section.stride = LittleEndian::get32(entry + 4);
+            section.first = LittleEndian::get32(entry + 8);
+            section.count = LittleEndian::get32(entry + 12);
+            section.offset = LittleEndian::get64(entry + 16);
+
+            bool valid = section.key.gridSize > 0 && section.key.gridSize <= CompactBoard::MAX_SIZE &&
+                section.stride == recordSize(section.key) && section.first == expectedFirst &&
+                section.offset + static_cast<uint64_t>(section.count) * section.stride <= file.size();
+            if (!valid) {
+                close();
+                return false;
+            }
+            expectedFirst += section.count;
+            sections.push_back(section);
+        }
+        if (expectedFirst != puzzleCount) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        file.close();
+        sections.clear();
+        puzzleCount = 0;
+    }
+
+    bool isOpen() const { return file.isOpen(); }
+    size_t size() const { return puzzleCount; }
+
+    // Puzzles stored for one key; they are numbered consecutively from firstOf(key)
+    size_t count(const PuzzleKey& key) const {
+        const Section* section = sectionFor(key);
+        return section ? section->count : 0;
+    }
+
+    size_t firstOf(const PuzzleKey& key) const {
+        const Section* section = sectionFor(key);
+        return section ? section->first : 0;
+    }
+
+    bool keyOf(size_t number, PuzzleKey& key) const {
+        const Section* section = sectionOf(number);
+        if (!section) return false;
+        key = section->key;
+        return true;
+    }
+
+    // Decodes puzzle `number` into an engine board with the clues shown and the pieces unplaced,
+    // and optionally into a solution board with every piece placed
+    bool load(size_t number, CompactBoard& puzzle, CompactBoard* solution = nullptr) const {
+        const Section* section = sectionOf(number);
+        if (!section) return false;
+
+        CompactBoard scratch;
+        CompactBoard& solved = solution ? *solution : scratch;
+        return decode(*section, recordOf(*section, number), puzzle, solved);
+    }
+
+    // Same, as a GeneratedPuzzle for DominoGame::installPuzzle
+    bool load(size_t number, GeneratedPuzzle& result) const {
+        const Section* section = sectionOf(number);
+        if (!section) return false;
+
+        CompactBoard puzzle, solved;
+        const uint8_t* record = recordOf(*section, number);
+        if (!decode(*section, record, puzzle, solved)) return false;
+
+        int n = section->key.gridSize;
+        result = GeneratedPuzzle();
+        result.gridSize = n;
+        result.extendedSet = section->key.extendedSet;
+        result.difficulty = section->key.difficulty;
+        result.grade.solvable = true;
+        result.grade.tier = record[1];
+        result.grade.score = LittleEndian::get16(record + 2);
+        result.clues.assign(n, std::vector<int>(n, 0));
+        for (int row = 0; row < n; ++row) {
+            for (int col = 0; col < n; ++col) {
+                result.clues[row][col] = puzzle.getClue(row, col);
+            }
+        }
+        for (int i = 0; i < solved.pieceCount(); ++i) {
+            const CompactPiece& p = solved.piece(i);
+            Domino domino(p.value1, p.value2);
+            domino.place(Position(p.row, p.col), p.vertical ? Orientation::VERTICAL : Orientation::HORIZONTAL);
+            result.solution.push_back(domino);
+        }
+        return true;
+    }
+
+    // Writes a library from a batch of puzzles, grouped by key, with one buffered write
+    // to a temporary file that then replaces `path`. Fails if any puzzle cannot be encoded.
+    static bool write(const std::string& path, const std::vector<GeneratedPuzzle>& puzzles) {
+        std::vector<const GeneratedPuzzle*> ordered;
+        for (const auto& puzzle : puzzles) {
+            ordered.push_back(&puzzle);
+        }
+        std::stable_sort(ordered.begin(), ordered.end(), [](const GeneratedPuzzle* a, const GeneratedPuzzle* b) {
+            return keyOrder(a->key()) < keyOrder(b->key());
+        });
+
+        std::vector<Section> layout;
+        for (const GeneratedPuzzle* puzzle : ordered) {
+            PuzzleKey key = puzzle->key();
+            if (layout.empty() || keyOrder(layout.back().key) != keyOrder(key)) {
+                Section section;
+                section.key = key;
+                section.stride = static_cast<uint32_t>(recordSize(key));
+                section.first = layout.empty() ? 0 : layout.back().first + layout.back().count;
+                section.count = 0;
+                section.offset = 0;
+                layout.push_back(section);
+            }
+            ++layout.back().count;
+        }
+
+        uint64_t offset = HEADER_SIZE + layout.size() * SECTION_SIZE;
+        for (auto& section : layout) {
+            section.offset = offset;
+            offset += static_cast<uint64_t>(section.count) * section.stride;
+        }
+
+        std::vector<uint8_t> buffer(static_cast<size_t>(offset), 0);
+        uint8_t* header = buffer.data();
+        LittleEndian::put32(header, MAGIC);
+        LittleEndian::put16(header + 4, FORMAT_VERSION);
+        LittleEndian::put16(header + 6, DominoGame::GENERATOR_VERSION);
+        LittleEndian::put32(header + 8, static_cast<uint32_t>(layout.size()));
+        LittleEndian::put32(header + 12, static_cast<uint32_t>(ordered.size()));
+
+        size_t next = 0;
+        for (size_t i = 0; i < layout.size(); ++i) {
+            const Section& section = layout[i];
+            uint8_t* entry = header + HEADER_SIZE + i * SECTION_SIZE;
+            entry[0] = static_cast<uint8_t>(section.key.gridSize);
+            entry[1] = static_cast<uint8_t>(section.key.difficulty);
+            entry[2] = section.key.extendedSet ? 1 : 0;
+            LittleEndian::put32(entry + 4, section.stride);
+            LittleEndian::put32(entry + 8, section.first);
+            LittleEndian::put32(entry + 12, section.count);
+            LittleEndian::put64(entry + 16, section.offset);
+
+            for (uint32_t j = 0; j < section.count; ++j) {
+                uint8_t* record = buffer.data() + section.offset + static_cast<uint64_t>(j) * section.stride;
+                if (!encode(*ordered[next++], record)) {
+                    return false;
+                }
+            }
+        }
+        LittleEndian::put32(header + 16, indexCrc(header, HEADER_SIZE + layout.size() * SECTION_SIZE));
+
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return false;
+            out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            if (!out.good()) return false;
+        }
+        return PlatformFile::replace(temporary, path);
+    }
+
+    static size_t recordSize(const PuzzleKey& key) {
+        int cells = key.gridSize * key.gridSize;
+        return RECORD_FIELDS + maxPieces(key) * PIECE_SIZE + (cells + 7) / 8;
+    }
+
+private:
+    static int keyOrder(const PuzzleKey& key) {
+        return (key.gridSize * 3 + static_cast<int>(key.difficulty)) * 2 + (key.extendedSet ? 1 : 0);
+    }
+
+    static int maxPieces(const PuzzleKey& key) {
+        int maxValue = key.extendedSet ? 9 : 6;
+        int setSize = (maxValue + 1) * (maxValue + 2) / 2;
+        int cells = key.gridSize * key.gridSize / 2;
+        int limit = cells < setSize ? cells : setSize;
+        return limit < CompactBoard::MAX_PIECES ? limit : CompactBoard::MAX_PIECES;
+    }
+
+    // CRC of the header (minus its own CRC field) and the section index
+    static uint32_t indexCrc(const uint8_t* header, size_t indexEnd) {
+        uint32_t crc = Crc32::compute(header, 16);
+        return Crc32::compute(header + 20, indexEnd - 20, crc);
+    }
+
+    const Section* sectionFor(const PuzzleKey& key) const {
+        for (const auto& section : sections) {
+            if (keyOrder(section.key) == keyOrder(key)) return &section;
+        }
+        return nullptr;
+    }
+
+    const Section* sectionOf(size_t number) const {
+        if (number >= puzzleCount) return nullptr;
+        auto it = std::upper_bound(sections.begin(), sections.end(), number,
+            [](size_t n, const Section& section) { return n < section.first; });
+        return &*(it - 1);
+    }
+
+    const uint8_t* recordOf(const Section& section, size_t number) const {
+        return file.data() + section.offset + (number - section.first) * section.stride;
+    }
+
+    static bool encode(const GeneratedPuzzle& puzzle, uint8_t* record) {
+        PuzzleKey key = puzzle.key();
+        int n = key.gridSize;
+        int pieces = static_cast<int>(puzzle.solution.size());
+        if (n <= 0 || n > CompactBoard::MAX_SIZE || pieces == 0 || pieces > maxPieces(key) ||
+            static_cast<int>(puzzle.clues.size()) != n) {
+            return false;
+        }
+
+        CompactBoard solved;
+        solved.reset(n);
+        record[0] = static_cast<uint8_t>(pieces);
+        record[1] = static_cast<uint8_t>(puzzle.grade.tier);
+        LittleEndian::put16(record + 2, static_cast<uint16_t>(puzzle.grade.score));
+
+        uint8_t* out = record + RECORD_FIELDS;
+        for (const auto& domino : puzzle.solution) {
+            Position pos = domino.getPosition();
+            int v1 = domino.getValue1(), v2 = domino.getValue2();
+            int vertical = domino.getOrientation() == Orientation::VERTICAL ? 1 : 0;
+            if (v1 < 0 || v1 > 15 || v2 < 0 || v2 > 15 || !pos.isValidForGrid(n) ||
+                (vertical ? pos.row + 1 : pos.col + 1) >= n) {
+                return false;
+            }
+
+            solved.placeUnchecked(solved.addPiece(v1, v2), pos.row, pos.col, vertical);
+            out[0] = static_cast<uint8_t>((v1 << 4) | v2);
+            LittleEndian::put16(out + 1, static_cast<uint16_t>((pos.row * n + pos.col) * 2 + vertical));
+            out += PIECE_SIZE;
+        }
+
+        uint8_t* shown = record + RECORD_FIELDS + maxPieces(key) * PIECE_SIZE;
+        for (int row = 0; row < n; ++row) {
+            if (static_cast<int>(puzzle.clues[row].size()) != n) return false;
+            for (int col = 0; col < n; ++col) {
+                int clue = puzzle.clues[row][col];
+                if (clue <= 0) continue;
+                if (clue != solved.adjacentSum(row, col)) return false;
+                int cell = row * n + col;
+                shown[cell >> 3] |= static_cast<uint8_t>(1u << (cell & 7));
+            }
+        }
+        return true;
+    }
+
+    static bool decode(const Section& section, const uint8_t* record, CompactBoard& puzzle, CompactBoard& solved) {
+        int n = section.key.gridSize;
+        int pieces = record[0];
+        if (pieces == 0 || pieces > maxPieces(section.key)) return false;
+
+        puzzle.reset(n);
+        solved.reset(n);
+        const uint8_t* in = record + RECORD_FIELDS;
+        for (int i = 0; i < pieces; ++i, in += PIECE_SIZE) {
+            int v1 = in[0] >> 4, v2 = in[0] & 0x0F;
+            int placement = LittleEndian::get16(in + 1);
+            int cell = placement >> 1;
+            int row = cell / n, col = cell % n, vertical = placement & 1;
+            if (cell >= n * n || (vertical ? row + 1 : col + 1) >= n) return false;
+
+            puzzle.addPiece(v1, v2);
+            solved.placeUnchecked(solved.addPiece(v1, v2), row, col, vertical);
+        }
+
+        const uint8_t* shown = record + RECORD_FIELDS + maxPieces(section.key) * PIECE_SIZE;
+        for (int cell = 0; cell < n * n; ++cell) {
+            if (!(shown[cell >> 3] & (1u << (cell & 7)))) continue;
+            int row = cell / n, col = cell % n;
+            int clue = solved.adjacentSum(row, col);
+            puzzle.setClue(row, col, clue);
+            solved.setClue(row, col, clue);
+        }
+        return true;
+    }
+};
@@ -0,0 +1,264 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "GameGrid.h"
+#include "AsyncGenerator.h"
+#include "MpmcQueue.h"
+#include "PuzzleCache.h"
+
+// Counters for tuning capacity, watermark and worker count
+struct PuzzlePoolStats {
+    uint64_t hits;              // takes served from the shelf
+    uint64_t misses;            // takes that found the shelf empty
+    uint64_t refills;           // puzzles added by background workers
+    uint64_t failedRefills;     // background generations that produced nothing, or missed the difficulty
+    uint64_t cacheLoads;        // puzzles restocked from the disk cache instead of generated
+    uint64_t refillMicros;      // time from queueing a refill to its completion, summed
+    uint64_t uptimeMicros;      // pool lifetime so far
+    int ready;                  // puzzles on the shelf now
+    int inFlight;               // refills queued or running
+
+    PuzzlePoolStats() : hits(0), misses(0), refills(0), failedRefills(0), cacheLoads(0), refillMicros(0),
+        uptimeMicros(0), ready(0), inFlight(0) {}
+
+    double hitRate() const {
+        uint64_t takes = hits + misses;
+        return takes > 0 ? static_cast<double>(hits) / takes : 0.0;
+    }
+
+    // Puzzles added per second since the pool started
+    double refillsPerSecond() const {
+        return uptimeMicros > 0 ? refills * 1e6 / uptimeMicros : 0.0;
+    }
+
+    double averageRefillMs() const {
+        uint64_t finished = refills + failedRefills;
+        return finished > 0 ? refillMicros / 1000.0 / finished : 0.0;
+    }
+};
+
+// Keeps a few ready-made puzzles for every (grid size, difficulty, set) the
+// player has asked for, so starting a game is a queue pop instead of a
+// generation. Each shelf is a lock-free queue that background workers top up
+// to capacity whenever a take leaves it below the watermark. A miss still
+// gives the caller a game: it generates on the spot, as before.
+//
+// With a PuzzleCache attached, shelves restock from disk before generating,
+// and whatever is left on the shelves is written back when the pool closes,
+// so the next run starts warm.
+class PuzzlePool {
+public:
+    static const int DEFAULT_CAPACITY = 4;
+    static const int DEFAULT_WATERMARK = 2;
+    static const int DEFAULT_REFILL_BUDGET_MS = 1000;
+
+private:
+    static const int MAX_GRID_SIZE = 20;
+    static const int DIFFICULTY_COUNT = 3;
+    static const int SHELF_COUNT = (MAX_GRID_SIZE + 1) * DIFFICULTY_COUNT * 2;
+
+    struct Shelf {
+        MpmcQueue<GeneratedPuzzle> ready;
+        std::atomic<int> inFlight;
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+        std::atomic<uint64_t> refills;
+        std::atomic<uint64_t> failedRefills;
+        std::atomic<uint64_t> cacheLoads;
+        std::atomic<uint64_t> refillMicros;
+
+        explicit Shelf(int capacity)
+            : ready(capacity), inFlight(0), hits(0), misses(0), refills(0), failedRefills(0), cacheLoads(0),
+              refillMicros(0) {}
+    };
+
+    int capacity;
+    int watermark;
+    int refillBudgetMs;
+    std::chrono::steady_clock::time_point started;
+    PuzzleCache* cache;
+
+    // Shelves are created on first use and live as long as the pool, so lookups need no lock
+    std::atomic<Shelf*> shelves[SHELF_COUNT];
+
+    // Declared last: destroyed first, so its workers are joined before the shelves go away
+    std::unique_ptr<AsyncGenerator> generator;
+
+public:
+    explicit PuzzlePool(int shelfCapacity = DEFAULT_CAPACITY, int lowWatermark = DEFAULT_WATERMARK,
+        int workerCount = 0, int budgetMs = DEFAULT_REFILL_BUDGET_MS)
+        : capacity(shelfCapacity > 0 ? shelfCapacity : 1),
+          watermark(lowWatermark < capacity ? lowWatermark : capacity),
+          refillBudgetMs(budgetMs), started(std::chrono::steady_clock::now()), cache(nullptr) {
+        for (auto& shelf : shelves) {
+            shelf.store(nullptr, std::memory_order_relaxed);
+        }
+        generator.reset(new AsyncGenerator(workerCount));
+    }
+
+    ~PuzzlePool() {
+        generator.reset();
+        for (auto& slot : shelves) {
+            Shelf* shelf = slot.load(std::memory_order_acquire);
+            GeneratedPuzzle puzzle;
+            while (cache && shelf && shelf->ready.tryPop(puzzle)) {
+                cache->store(puzzle);
+            }
+            delete shelf;
+        }
+    }
+
+    PuzzlePool(const PuzzlePool&) = delete;
+    PuzzlePool& operator=(const PuzzlePool&) = delete;
+
+    // Restock from and save leftovers to `diskCache`, which must outlive the pool.
+    // Call before the first prefill or take.
+    void attachCache(PuzzleCache* diskCache) {
+        cache = diskCache;
+    }
+
+    // Starts filling a shelf ahead of the first game, e.g. for the size on the settings page
+    void prefill(const PuzzleKey& key) {
+        Shelf* shelf = shelfFor(key);
+        if (shelf) {
+            refill(key, *shelf);
+        }
+    }
+
+    // Pops a ready puzzle. Returns false on a miss; either way the shelf is topped up if it runs low.
+    bool take(const PuzzleKey& key, GeneratedPuzzle& puzzle) {
+        Shelf* shelf = shelfFor(key);
+        if (!shelf) return false;
+
+        bool hit = shelf->ready.tryPop(puzzle);
+        (hit ? shelf->hits : shelf->misses).fetch_add(1, std::memory_order_relaxed);
+
+        if (static_cast<int>(shelf->ready.sizeApprox()) < watermark) {
+            refill(key, *shelf);
+        }
+        return hit;
+    }
+
+    // Starts a new game from the pool, generating synchronously on a miss.
+    // Returns true if the game came from the pool.
+    bool startGame(DominoGame& game, Difficulty difficulty) {
+        PuzzleKey key(game.getGridSize(), difficulty, game.isUsingExtendedSet());
+        GeneratedPuzzle puzzle;
+        if (take(key, puzzle)) {
+            game.installPuzzle(puzzle);
+            return true;
+        }
+        game.generateNewGame(difficulty);
+        return false;
+    }
+
+    PuzzlePoolStats getStats(const PuzzleKey& key) const {
+        PuzzlePoolStats stats;
+        int index = shelfIndex(key);
+        const Shelf* shelf = index >= 0 ? shelves[index].load(std::memory_order_acquire) : nullptr;
+        if (shelf) {
+            accumulate(*shelf, stats);
+        }
+        stats.uptimeMicros = uptimeMicros();
+        return stats;
+    }
+
+    // Totals over every shelf
+    PuzzlePoolStats getStats() const {
+        PuzzlePoolStats stats;
+        for (const auto& slot : shelves) {
+            const Shelf* shelf = slot.load(std::memory_order_acquire);
+            if (shelf) {
+                accumulate(*shelf, stats);
+            }
+        }
+        stats.uptimeMicros = uptimeMicros();
+        return stats;
+    }
+
+    int getCapacity() const { return capacity; }
+    int getWatermark() const { return watermark; }
+
+private:
+    static int shelfIndex(const PuzzleKey& key) {
+        int level = static_cast<int>(key.difficulty);
+        if (key.gridSize <= 0 || key.gridSize > MAX_GRID_SIZE || level < 0 || level >= DIFFICULTY_COUNT) {
+            return -1;
+        }
+        return (key.gridSize * DIFFICULTY_COUNT + level) * 2 + (key.extendedSet ? 1 : 0);
+    }
+
+    Shelf* shelfFor(const PuzzleKey& key) {
+        int index = shelfIndex(key);
+        if (index < 0) return nullptr;
+
+        Shelf* shelf = shelves[index].load(std::memory_order_acquire);
+        if (shelf) return shelf;
+
+        Shelf* created = new Shelf(capacity);
+        if (shelves[index].compare_exchange_strong(shelf, created, std::memory_order_acq_rel)) {
+            return created;
+        }
+        delete created;     // another thread won the race; `shelf` now holds its shelf
+        return shelf;
+    }
+
+    // Restocks from the disk cache, then queues enough generations to bring the shelf back to capacity
+    void refill(const PuzzleKey& key, Shelf& shelf) {
+        if (cache) {
+            GeneratedPuzzle stored;
+            while (capacity - static_cast<int>(shelf.ready.sizeApprox()) - shelf.inFlight.load() > 0 &&
+                cache->take(key, stored)) {
+                if (!shelf.ready.tryPush(stored)) {
+                    cache->store(stored);
+                    break;
+                }
+                shelf.cacheLoads.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        for (;;) {
+            int pending = shelf.inFlight.load(std::memory_order_relaxed);
+            int wanted = capacity - static_cast<int>(shelf.ready.sizeApprox()) - pending;
+            if (wanted <= 0) return;
+            if (!shelf.inFlight.compare_exchange_weak(pending, pending + 1, std::memory_order_relaxed)) continue;
+
+            GenerationRequest request(key.gridSize, key.extendedSet, key.difficulty, refillBudgetMs);
+            Shelf* target = &shelf;
+            auto queued = std::chrono::steady_clock::now();
+            generator->submit(request, nullptr, [target, queued](const GenerationOutcome& outcome) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - queued);
+                target->refillMicros.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+
+                // Fallbacks and puzzles that missed the tier are dropped: a take must deal the difficulty asked for
+                bool onTarget = outcome.result.success && outcome.result.metTargets && !outcome.result.timedOut;
+                if (onTarget && outcome.puzzle.isValid() && target->ready.tryPush(outcome.puzzle)) {
+                    target->refills.fetch_add(1, std::memory_order_relaxed);
+                }
+                else {
+                    target->failedRefills.fetch_add(1, std::memory_order_relaxed);
+                }
+                target->inFlight.fetch_sub(1, std::memory_order_relaxed);
+            });
+        }
+    }
+
+    uint64_t uptimeMicros() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started).count());
+    }
+
+    static void accumulate(const Shelf& shelf, PuzzlePoolStats& stats) {
+        stats.hits += shelf.hits.load(std::memory_order_relaxed);
+        stats.misses += shelf.misses.load(std::memory_order_relaxed);
+        stats.refills += shelf.refills.load(std::memory_order_relaxed);
+        stats.failedRefills += shelf.failedRefills.load(std::memory_order_relaxed);
+        stats.cacheLoads += shelf.cacheLoads.load(std::memory_order_relaxed);
+        stats.refillMicros += shelf.refillMicros.load(std::memory_order_relaxed);
+        stats.ready += static_cast<int>(shelf.ready.sizeApprox());
+        stats.inFlight += shelf.inFlight.load(std::memory_order_relaxed);
+    }
+};
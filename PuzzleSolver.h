@@ -0,0 +1,461 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "CompactBoard.h"
+#include "ClueSumTables.h"
+#include "FeasibilityCheck.h"
+#include "CancellationToken.h"
+#include "SearchStats.h"
+#include "SearchArena.h"
+
+enum class SolveStatus {
+    SOLVED,
+    UNSOLVABLE,
+    TIMED_OUT,
+    CANCELLED
+};
+
+struct SolveResult {
+    SolveStatus status;
+    CompactBoard solution;        // valid when status == SOLVED
+    CompactMove firstMove;        // first placement made on the path to the solution
+    bool hasFirstMove;
+    uint64_t nodes;
+    FeasibilityReport infeasibility;  // why the start board was rejected without searching
+    SearchStats stats;            // every search since the solver's clock started
+
+    SolveResult() : status(SolveStatus::UNSOLVABLE), firstMove(), hasFirstMove(false), nodes(0) {}
+};
+
+// What the hint engine concluded about the player's current board
+struct SolverHint {
+    enum Status {
+        PLACEMENT,      // move extends to a full solution
+        WRONG_PIECE,    // move is the earliest placed piece that rules out every solution
+        SOLVED,         // board is already solved
+        NO_SOLUTION,    // even the empty board has no solution under the player rules
+        TIMED_OUT,
+        CANCELLED
+    };
+
+    Status status;
+    CompactMove move;
+    uint64_t nodes;
+    SearchStats stats;          // all the searches the hint needed
+
+    SolverHint() : status(NO_SOLUTION), move(), nodes(0) {}
+};
+
+// Depth-first solver over CompactBoard. Branches on the unplaced piece with the
+// fewest legal placements and prunes placements after which an adjacent clue
+// can no longer be made from the sums still available. Every search is bounded
+// by a wall-clock budget.
+class PuzzleSolver {
+public:
+    static const int DEFAULT_TIME_BUDGET_MS = 100;
+
+private:
+    static const int CHECK_INTERVAL = 256;
+
+    int timeBudgetMs;
+    std::chrono::steady_clock::time_point deadline;
+    CancellationToken cancelToken;
+    uint64_t nodes;
+    bool timedOut;
+    bool cancelled;
+    SearchStats stats;
+    bool searchStarted;
+    SearchArena arena;          // per-node placement lists
+
+    CompactMove firstMove;
+    bool hasFirstMove;
+
+public:
+    explicit PuzzleSolver(int budgetMs = DEFAULT_TIME_BUDGET_MS)
+        : timeBudgetMs(budgetMs), nodes(0), timedOut(false), cancelled(false), searchStarted(false),
+        firstMove(), hasFirstMove(false) {
+    }
+
+    void setTimeBudget(int budgetMs) { timeBudgetMs = budgetMs; }
+    int getTimeBudget() const { return timeBudgetMs; }
+
+    // Completes the board under the player rules, or proves that it cannot be done
+    SolveResult solve(const CompactBoard& start, const CancellationToken& cancel = CancellationToken()) {
+        startClock(cancel);
+        return solveWithinDeadline(start);
+    }
+
+    // Hint for the player's board: a placement that extends to a solution, or the earliest wrong piece.
+    // When a stored solution is given and the player's pieces agree with it, no search is needed.
+    SolverHint findHint(const CompactBoard& current, const CompactBoard* storedSolution = nullptr,
+        const CancellationToken& cancel = CancellationToken()) {
+        SolverHint hint;
+
+        if (current.isComplete() && current.cluesSatisfied()) {
+            hint.status = SolverHint::SOLVED;
+            return hint;
+        }
+
+        if (storedSolution && nextMoveFromSolution(current, *storedSolution, hint.move)) {
+            hint.status = SolverHint::PLACEMENT;
+            return hint;
+        }
+
+        startClock(cancel);
+        SolveResult result = solveWithinDeadline(current);
+        hint.nodes = nodes;
+        hint.stats = stats;
+
+        if (result.status == SolveStatus::SOLVED) {
+            if (result.hasFirstMove) {
+                hint.status = SolverHint::PLACEMENT;
+                hint.move = result.firstMove;
+            }
+            else {
+                hint.status = SolverHint::SOLVED;
+            }
+            return hint;
+        }
+        if (result.status != SolveStatus::UNSOLVABLE) {
+            hint.status = statusFor(result.status);
+            return hint;
+        }
+
+        // Placement order prefixes are monotonic: once a prefix is unsolvable, every longer one is too
+        int low = 0;
+        int high = current.placedCount();
+        while (low + 1 < high) {
+            int mid = (low + high) / 2;
+            SolveResult probe = solveWithinDeadline(prefixBoard(current, mid));
+            if (probe.status == SolveStatus::SOLVED) {
+                low = mid;
+            }
+            else if (probe.status == SolveStatus::UNSOLVABLE) {
+                high = mid;
+            }
+            else {
+                hint.status = statusFor(probe.status);
+                hint.nodes = nodes;
+                hint.stats = stats;
+                return hint;
+            }
+        }
+
+        hint.nodes = nodes;
+        hint.stats = stats;
+        if (high == 0) {
+            hint.status = SolverHint::NO_SOLUTION;
+            return hint;
+        }
+        if (low == 0) {
+            // The bisection never looked at the empty board; make sure the puzzle itself is solvable
+            SolveResult empty = solveWithinDeadline(prefixBoard(current, 0));
+            hint.nodes = nodes;
+            hint.stats = stats;
+            if (empty.status != SolveStatus::SOLVED) {
+                hint.status = empty.status == SolveStatus::UNSOLVABLE ? SolverHint::NO_SOLUTION : statusFor(empty.status);
+                return hint;
+            }
+        }
+
+        hint.status = SolverHint::WRONG_PIECE;
+        hint.move = placedMove(current, high);
+        return hint;
+    }
+
+    uint64_t getNodeCount() const { return nodes; }
+    const SearchStats& getStats() const { return stats; }
+
+    // True if every placed piece sits exactly where the solution has it
+    static bool agreesWithSolution(const CompactBoard& current, const CompactBoard& solution) {
+        for (int i = 0; i < current.pieceCount(); ++i) {
+            const CompactPiece& p = current.piece(i);
+            if (!p.isPlaced()) continue;
+            int owner = solution.ownerAt(p.row, p.col);
+            if (owner < 0) return false;
+            const CompactPiece& s = solution.piece(owner);
+            if (s.row != p.row || s.col != p.col || s.vertical != p.vertical ||
+                s.value1 + s.value2 != p.value1 + p.value2 || s.digitMask() != p.digitMask()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    void startClock(const CancellationToken& cancel) {
+        cancelToken = cancel;
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeBudgetMs);
+        nodes = 0;
+        timedOut = false;
+        cancelled = false;
+        stats.reset();
+        searchStarted = false;
+    }
+
+    SolveResult solveWithinDeadline(const CompactBoard& start) {
+        SolveResult result;
+        hasFirstMove = false;
+        uint64_t startNodes = nodes;
+        if (searchStarted) {
+            stats.restarted();
+        }
+        searchStarted = true;
+
+        result.infeasibility = FeasibilityCheck::check(start);
+        if (!result.infeasibility.isFeasible()) {
+            stats.pruned(SearchStats::PRUNE_FEASIBILITY);
+            result.stats = stats;
+            return result;
+        }
+
+        CompactBoard board = start;
+        bool found = !timedOut && !cancelled && search(board, 0);
+
+        result.nodes = nodes - startNodes;
+        result.stats = stats;
+        if (found) {
+            result.status = SolveStatus::SOLVED;
+            result.solution = board;
+            result.firstMove = firstMove;
+            result.hasFirstMove = hasFirstMove;
+        }
+        else if (cancelled) {
+            result.status = SolveStatus::CANCELLED;
+        }
+        else if (timedOut) {
+            result.status = SolveStatus::TIMED_OUT;
+        }
+        else {
+            result.status = SolveStatus::UNSOLVABLE;
+        }
+        return result;
+    }
+
+    bool outOfTime() {
+        if ((nodes % CHECK_INTERVAL) != 0) return false;
+        if (cancelToken.isCancelled()) {
+            cancelled = true;
+        }
+        else if (std::chrono::steady_clock::now() >= deadline) {
+            timedOut = true;
+        }
+        return timedOut || cancelled;
+    }
+
+    bool search(CompactBoard& board, int depth) {
+        ++nodes;
+        stats.visit(depth);
+        if (outOfTime()) return false;
+
+        if (board.isComplete()) {
+            return board.cluesSatisfied();
+        }
+        if (depth > 0 && !FeasibilityCheck::check(board).isFeasible()) {
+            stats.pruned(SearchStats::PRUNE_FEASIBILITY);
+            return false;
+        }
+
+        uint32_t available = 0;
+        bool useTables = tableSums(board, available);
+
+        // Pick the unplaced piece with the fewest viable placements
+        int bestPiece = -1;
+        int bestCount = 0;
+        for (int i = 0; i < board.pieceCount(); ++i) {
+            if (board.piece(i).isPlaced()) continue;
+            int count = countPlacements(board, i, bestPiece == -1 ? -1 : bestCount, useTables, available);
+            if (count == 0) return false;
+            if (bestPiece == -1 || count < bestCount) {
+                bestPiece = i;
+                bestCount = count;
+            }
+        }
+
+        SearchArena::Frame frame(arena);
+        uint16_t* placements = arena.allocate<uint16_t>(bestCount);
+        int placementCount = collectPlacements(board, bestPiece, placements, bestCount, useTables, available, stats);
+
+        for (int i = 0; i < placementCount; ++i) {
+            uint16_t encoded = placements[i];
+            int row = (encoded >> 1) / CompactBoard::MAX_SIZE;
+            int col = (encoded >> 1) % CompactBoard::MAX_SIZE;
+            int vertical = encoded & 1;
+
+            board.placeUnchecked(bestPiece, row, col, vertical);
+            stats.tried();
+            if (search(board, depth + 1)) {
+                if (depth == 0) {
+                    const CompactPiece& p = board.piece(bestPiece);
+                    firstMove = { bestPiece, p.value1, p.value2, row, col, vertical };
+                    hasFirstMove = true;
+                }
+                return true;
+            }
+            board.remove(bestPiece);
+            stats.backtracked();
+
+            if (timedOut || cancelled) return false;
+        }
+
+        return false;
+    }
+
+    // Counts viable placements, stopping early once the count can no longer beat the current best
+    static int countPlacements(const CompactBoard& board, int piece, int stopAt, bool useTables, uint32_t available) {
+        int count = 0;
+        for (int row = 0; row < board.size(); ++row) {
+            for (int col = 0; col < board.size(); ++col) {
+                for (int vertical = 0; vertical <= 1; ++vertical) {
+                    if (isViable(board, piece, row, col, vertical, useTables, available)) {
+                        ++count;
+                        if (stopAt >= 0 && count >= stopAt) return count;
+                    }
+                }
+            }
+        }
+        return count;
+    }
+
+    // Writes up to `capacity` viable placements to `out` and returns how many it wrote.
+    // Each candidate is checked once; a rejected one is attributed by the conflict that check returned.
+    static int collectPlacements(const CompactBoard& board, int piece, uint16_t* out, int capacity,
+        bool useTables, uint32_t available, SearchStats& stats) {
+        int count = 0;
+        for (int row = 0; row < board.size(); ++row) {
+            for (int col = 0; col < board.size(); ++col) {
+                for (int vertical = 0; vertical <= 1; ++vertical) {
+                    PlacementConflict conflict = board.checkPlacement(piece, row, col, vertical);
+                    if (conflict == PlacementConflict::NONE &&
+                        !breaksClues(board, piece, row, col, vertical, useTables, available)) {
+                        if (count < capacity) {
+                            out[count++] = static_cast<uint16_t>((CompactBoard::cellIndex(row, col) << 1) | vertical);
+                        }
+                    }
+                    else {
+                        recordPrune(conflict, stats);
+                    }
+                }
+            }
+        }
+        return count;
+    }
+
+    // Attributes a dropped placement of the branching piece to the rule that ruled it out;
+    // NONE means the board allowed it and a neighbouring clue did not
+    static void recordPrune(PlacementConflict conflict, SearchStats& stats) {
+#if DOMINO_SEARCH_STATS
+        switch (conflict) {
+        case PlacementConflict::OCCUPIED: stats.pruned(SearchStats::PRUNE_OCCUPIED); break;
+        case PlacementConflict::CLUE_CELL: stats.pruned(SearchStats::PRUNE_CLUE_CELL); break;
+        case PlacementConflict::TOUCH: stats.pruned(SearchStats::PRUNE_TOUCH); break;
+        case PlacementConflict::ROW_DIGIT: stats.pruned(SearchStats::PRUNE_ROW_DIGIT); break;
+        case PlacementConflict::COLUMN_DIGIT: stats.pruned(SearchStats::PRUNE_COLUMN_DIGIT); break;
+        case PlacementConflict::DUPLICATE_SUM: stats.pruned(SearchStats::PRUNE_SUM); break;
+        case PlacementConflict::NONE: stats.pruned(SearchStats::PRUNE_SUM); break;
+        default: break;     // off the board: not a candidate at all
+        }
+#else
+        (void)conflict; (void)stats;
+#endif
+    }
+
+    static bool isViable(const CompactBoard& board, int piece, int row, int col, int vertical,
+        bool useTables, uint32_t available) {
+        return board.canPlace(piece, row, col, vertical) &&
+            !breaksClues(board, piece, row, col, vertical, useTables, available);
+    }
+
+    // Sums of the unplaced pieces, when the clue partition tables apply to this board
+    static bool tableSums(const CompactBoard& board, uint32_t& available) {
+        available = 0;
+        if (!board.uniqueSumsEnforced()) return false;
+        for (int i = 0; i < board.pieceCount(); ++i) {
+            const CompactPiece& p = board.piece(i);
+            if (p.isPlaced()) continue;
+            if (p.sum() > ClueSumTables::MAX_PIECE_SUM) return false;
+            available |= 1u << p.sum();
+        }
+        available &= ~static_cast<uint32_t>(board.usedSums());
+        return true;
+    }
+
+    // Would the piece push a clue around it over its value, or leave a remainder
+    // that the other available sums cannot make up?
+    static bool breaksClues(const CompactBoard& board, int piece, int row, int col, int vertical,
+        bool useTables, uint32_t available) {
+        int sum = board.piece(piece).sum();
+        int row2 = vertical ? row + 1 : row;
+        int col2 = vertical ? col : col + 1;
+        int n = board.size();
+        uint32_t others = available & ~(1u << sum);
+
+        for (int r = row - 1; r <= row2 + 1; ++r) {
+            if (r < 0 || r >= n) continue;
+            for (int c = col - 1; c <= col2 + 1; ++c) {
+                if (c < 0 || c >= n) continue;
+                int clue = board.getClue(r, c);
+                if (clue == 0) continue;
+
+                int neighbours = 0;
+                int remainder = clue - board.adjacentSum(r, c, neighbours) - sum;
+                if (remainder < 0) {
+                    return true;
+                }
+                if (useTables && !ClueSumTables::instance().feasible(
+                    remainder, ClueSumTables::MAX_NEIGHBOURS - neighbours - 1, others)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // The stored solution's next piece, if the player's pieces all agree with it
+    static bool nextMoveFromSolution(const CompactBoard& current, const CompactBoard& solution, CompactMove& move) {
+        if (solution.size() != current.size() || !solution.isSolved() || !solution.isLegal() ||
+            !agreesWithSolution(current, solution)) {
+            return false;
+        }
+
+        for (int i = 0; i < solution.pieceCount(); ++i) {
+            const CompactPiece& s = solution.piece(i);
+            if (current.ownerAt(s.row, s.col) >= 0) continue;
+
+            int index = current.findPiece(s.value1, s.value2);
+            if (index < 0 || current.piece(index).isPlaced() ||
+                !current.canPlace(index, s.row, s.col, s.vertical)) {
+                return false;
+            }
+            move = { index, s.value1, s.value2, s.row, s.col, s.vertical };
+            return true;
+        }
+        return false;
+    }
+
+    // Board holding only the first `count` pieces in placement order
+    static CompactBoard prefixBoard(const CompactBoard& current, int count) {
+        CompactBoard board = current;
+        for (int i = 0; i < board.pieceCount(); ++i) {
+            if (board.piece(i).placeOrder > count) {
+                board.remove(i);
+            }
+        }
+        return board;
+    }
+
+    static CompactMove placedMove(const CompactBoard& board, int order) {
+        for (int i = 0; i < board.pieceCount(); ++i) {
+            const CompactPiece& p = board.piece(i);
+            if (p.placeOrder == order) {
+                return { i, p.value1, p.value2, p.row, p.col, p.vertical };
+            }
+        }
+        return CompactMove();
+    }
+
+    static SolverHint::Status statusFor(SolveStatus status) {
+        return status == SolveStatus::CANCELLED ? SolverHint::CANCELLED : SolverHint::TIMED_OUT;
+    }
+};
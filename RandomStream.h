@@ -0,0 +1,146 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// xoshiro256** (Blackman and Vigna): 32 bytes of state, a few cycles per draw, and
+// a jump of 2^128 steps, so one root seed yields as many non-overlapping streams as
+// there are workers or restarts. The output is fully specified here, so a seed gives
+// the same sequence with every compiler and standard library.
+class RandomStream {
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t value, int shift) {
+        return (value << shift) | (value >> (64 - shift));
+    }
+
+    // SplitMix64, which spreads even adjacent seeds over the whole state
+    static uint64_t mix(uint64_t& seed) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+public:
+    explicit RandomStream(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        for (uint64_t& word : state) {
+            word = mix(seed);
+        }
+    }
+
+    uint64_t next() {
+        const uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // The high half; the low bits of xoshiro output are its weakest
+    uint32_t next32() {
+        return static_cast<uint32_t>(next() >> 32);
+    }
+
+    // Uniform in [0, bound) without modulo bias (Lemire's multiply-and-reject);
+    // the division only runs when a draw lands in the short biased zone
+    uint32_t below(uint32_t bound) {
+        uint64_t product = static_cast<uint64_t>(next32()) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<uint64_t>(next32()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    // Advances this stream by 2^128 draws
+    void jump() {
+        static const uint64_t JUMP[4] = {
+            0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull
+        };
+        uint64_t jumped[4] = { 0, 0, 0, 0 };
+        for (uint64_t word : JUMP) {
+            for (int bit = 0; bit < 64; ++bit) {
+                if (word & (1ull << bit)) {
+                    for (int i = 0; i < 4; ++i) jumped[i] ^= state[i];
+                }
+                next();
+            }
+        }
+        for (int i = 0; i < 4; ++i) state[i] = jumped[i];
+    }
+
+    // Hands out the next 2^128 draws as a stream of their own and jumps past them.
+    // Successive splits of one root are independent and depend only on the root seed.
+    RandomStream split() {
+        RandomStream child(*this);
+        jump();
+        return child;
+    }
+
+    // Fisher-Yates over below()
+    template <typename T>
+    void shuffle(std::vector<T>& items) {
+        for (size_t i = items.size(); i > 1; --i) {
+            std::swap(items[i - 1], items[below(static_cast<uint32_t>(i))]);
+        }
+    }
+};
+
+// The numbers 0..n-1 in random order, drawn one at a time: Fisher-Yates run
+// incrementally, so a walk that stops after k draws costs k steps rather than n.
+// The table is put back to the identity when the next walk begins, again in
+// time proportional to the draws made.
+class LazyPermutation {
+private:
+    std::vector<uint32_t> table;        // the identity between walks
+    std::vector<uint32_t> partners;     // where each draw swapped from, for the undo
+
+public:
+    void resize(uint32_t count) {
+        table.resize(count);
+        for (uint32_t i = 0; i < count; ++i) table[i] = i;
+        partners.clear();
+        partners.reserve(count);
+    }
+
+    uint32_t size() const { return static_cast<uint32_t>(table.size()); }
+
+    void begin() {
+        for (size_t i = partners.size(); i-- > 0;) {
+            std::swap(table[i], table[partners[i]]);
+        }
+        partners.clear();
+    }
+
+    // False once every number has been drawn
+    bool next(RandomStream& rng, uint32_t& value) {
+        uint32_t drawn = static_cast<uint32_t>(partners.size());
+        if (drawn >= table.size()) return false;
+
+        uint32_t partner = drawn + rng.below(size() - drawn);
+        std::swap(table[drawn], table[partner]);
+        partners.push_back(partner);
+        value = table[drawn];
+        return true;
+    }
+
+    // The numbers this walk has not drawn yet, in table order
+    void remaining(std::vector<uint32_t>& out) const {
+        out.assign(table.begin() + partners.size(), table.end());
+    }
+
+    uint32_t drawnCount() const { return static_cast<uint32_t>(partners.size()); }
+};
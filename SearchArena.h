@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Bump allocator for the scratch of one search. Every node opens a Frame, takes
+// what it needs, and gives it all back at once when the frame closes on
+// backtrack. Blocks are kept for reuse, so once the first descent has sized the
+// arena a search makes no heap calls at all. One arena per solver: it is not
+// thread-safe, and workers with their own never meet in the global allocator.
+class SearchArena {
+public:
+    static const size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockSize;
+    size_t current;             // block being carved
+    size_t used;                // bytes taken from it
+
+public:
+    // Where the arena stood when a frame opened
+    struct Marker {
+        size_t block;
+        size_t used;
+    };
+
+    explicit SearchArena(size_t bytesPerBlock = DEFAULT_BLOCK_SIZE)
+        : blockSize(bytesPerBlock), current(0), used(0) {}
+
+    // Scratch is never shared: a copy starts empty
+    SearchArena(const SearchArena& other) : blockSize(other.blockSize), current(0), used(0) {}
+    SearchArena& operator=(const SearchArena& other) {
+        blockSize = other.blockSize;
+        return *this;
+    }
+
+    // Uninitialized room for `count` objects of a trivially destructible type
+    template <typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    void* allocateBytes(size_t bytes, size_t alignment) {
+        while (current < blocks.size()) {
+            uintptr_t base = reinterpret_cast<uintptr_t>(blocks[current].memory.get());
+            size_t offset = ((base + used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+            if (offset + bytes <= blocks[current].size) {
+                used = offset + bytes;
+                return blocks[current].memory.get() + offset;
+            }
+            ++current;
+            used = 0;
+        }
+
+        Block block;
+        block.size = bytes + alignment > blockSize ? bytes + alignment : blockSize;
+        block.memory.reset(new unsigned char[block.size]);
+        blocks.push_back(std::move(block));
+        current = blocks.size() - 1;
+        used = 0;
+        return allocateBytes(bytes, alignment);
+    }
+
+    Marker mark() const {
+        Marker marker = { current, used };
+        return marker;
+    }
+
+    void rewind(const Marker& marker) {
+        current = marker.block;
+        used = marker.used;
+    }
+
+    void reset() {
+        current = 0;
+        used = 0;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks) total += block.size;
+        return total;
+    }
+
+    // The scratch of one search node, released when the node returns
+    class Frame {
+    private:
+        SearchArena& arena;
+        Marker start;
+
+    public:
+        explicit Frame(SearchArena& owner) : arena(owner), start(owner.mark()) {}
+        ~Frame() { arena.rewind(start); }
+
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+    };
+};
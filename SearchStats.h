@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+
+// Build with DOMINO_SEARCH_STATS set to 0 to compile the counting out of the
+// searches; the structs stay in the results but read all zeros.
+#ifndef DOMINO_SEARCH_STATS
+#define DOMINO_SEARCH_STATS 1
+#endif
+
+// What a backtracking search did, for tuning the generator and solver heuristics.
+// Filled in by the generator's solution search and by PuzzleSolver.
+struct SearchStats {
+    // Why a candidate placement was dropped before it was tried
+    enum PruneRule {
+        PRUNE_OCCUPIED,         // a cell is already covered
+        PRUNE_CLUE_CELL,        // a cell holds a clue
+        PRUNE_TOUCH,            // the piece would touch another
+        PRUNE_ROW_DIGIT,        // a digit repeats in a row
+        PRUNE_COLUMN_DIGIT,     // a digit repeats in a column
+        PRUNE_SUM,              // the sum is taken, or a neighbouring clue can no longer be made
+        PRUNE_FEASIBILITY,      // a whole subtree failed FeasibilityCheck
+        PRUNE_RULE_COUNT
+    };
+
+    uint64_t nodes;             // search calls
+    uint64_t tries;             // placements made on the board
+    uint64_t backtracks;        // placements taken back after their subtree failed
+    uint64_t prunes[PRUNE_RULE_COUNT];
+    int maxDepth;
+    int restarts;               // searches begun again from the root
+
+    SearchStats() { reset(); }
+
+    void reset() {
+        nodes = 0;
+        tries = 0;
+        backtracks = 0;
+        for (uint64_t& count : prunes) count = 0;
+        maxDepth = 0;
+        restarts = 0;
+    }
+
+    static bool enabled() { return DOMINO_SEARCH_STATS != 0; }
+
+    uint64_t totalPrunes() const {
+        uint64_t total = 0;
+        for (uint64_t count : prunes) total += count;
+        return total;
+    }
+
+    void merge(const SearchStats& other) {
+        nodes += other.nodes;
+        tries += other.tries;
+        backtracks += other.backtracks;
+        for (int rule = 0; rule < PRUNE_RULE_COUNT; ++rule) prunes[rule] += other.prunes[rule];
+        maxDepth = maxDepth > other.maxDepth ? maxDepth : other.maxDepth;
+        restarts += other.restarts;
+    }
+
+    static const char* ruleName(int rule) {
+        switch (rule) {
+        case PRUNE_OCCUPIED: return "occupied";
+        case PRUNE_CLUE_CELL: return "clueCell";
+        case PRUNE_TOUCH: return "touch";
+        case PRUNE_ROW_DIGIT: return "rowDigit";
+        case PRUNE_COLUMN_DIGIT: return "columnDigit";
+        case PRUNE_SUM: return "sum";
+        case PRUNE_FEASIBILITY: return "feasibility";
+        default: return "unknown";
+        }
+    }
+
+    // Recording; each compiles to nothing without DOMINO_SEARCH_STATS
+    void visit(int depth) {
+#if DOMINO_SEARCH_STATS
+        ++nodes;
+        if (depth > maxDepth) maxDepth = depth;
+#else
+        (void)depth;
+#endif
+    }
+
+    void tried() {
+#if DOMINO_SEARCH_STATS
+        ++tries;
+#endif
+    }
+
+    void backtracked() {
+#if DOMINO_SEARCH_STATS
+        ++backtracks;
+#endif
+    }
+
+    void pruned(PruneRule rule) {
+#if DOMINO_SEARCH_STATS
+        ++prunes[rule];
+#else
+        (void)rule;
+#endif
+    }
+
+    void restarted() {
+#if DOMINO_SEARCH_STATS
+        ++restarts;
+#endif
+    }
+};
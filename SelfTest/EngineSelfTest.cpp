@@ -0,0 +1,1323 @@
+// Headless self-test for the game engine. Uses only the standard-library headers
+// (GameGrid.h, AsyncGenerator.h, PuzzleCache.h, ...), so it builds without MFC:
+//
+//   g++ -std=c++14 -O2 -I.. EngineSelfTest.cpp -o engine-selftest -pthread
+//   cl /std:c++14 /O2 /EHsc /I.. EngineSelfTest.cpp
+//
+// Add -DDOMINO_ALLOCATION_TRACKING=1 to also check that zero-allocation operations
+// do not allocate; without it that check is skipped.
+//
+// Runs every check in CHECKS, or only those whose name contains the first argument,
+// and prints each failed expectation with its line.
+// Exit code: 0 when every check passes, 1 otherwise.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
+#include "../GameGrid.h"
+#include "../AsyncGenerator.h"
+#include "../AutosaveJournal.h"
+#include "../ClueSumTables.h"
+#include "../FeasibilityCheck.h"
+#include "../HintSystem.h"
+#include "../PuzzleCache.h"
+#include "../PuzzleLibrary.h"
+#include "../PuzzlePool.h"
+
+std::atomic<int> Domino::nextId(0);
+
+#if DOMINO_ALLOCATION_TRACKING
+DOMINO_ALLOCATION_HOOKS
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+int failures = 0;
+
+#define EXPECT(condition) expect((condition), #condition, __LINE__)
+
+void expect(bool passed, const char* text, int line) {
+    if (!passed) {
+        ++failures;
+        std::printf("  line %d: expected %s\n", line, text);
+    }
+}
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Waits until a worker has picked the job up
+bool waitUntilRunning(const GenerationHandle& handle, int timeoutMs) {
+    Clock::time_point start = Clock::now();
+    while (handle.attempts() == 0 && !handle.isReady()) {
+        if (elapsedMs(start) > timeoutMs) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// A 6x6 extended-set board whose generation runs for over a second when left alone
+GenerationRequest slowRequest() {
+    GenerationRequest request(6, true, Difficulty::MEDIUM, 60000);
+    request.seed = 173;
+    return request;
+}
+
+// --- AsyncGenerator ---------------------------------------------------------
+
+void checkAsyncCompletionRunsOnDrainingThread() {
+    QueuedCompletions queue;
+    AsyncGenerator generator(1);
+
+    int calls = 0;
+    std::thread::id caller = std::this_thread::get_id();
+    std::thread::id ranOn;
+    GenerationOutcome delivered;
+    GenerationRequest request(8, false, Difficulty::EASY, 1000);
+    request.seed = 1;
+    GenerationHandle handle = generator.submit(request, &queue, [&](const GenerationOutcome& outcome) {
+        ++calls;
+        ranOn = std::this_thread::get_id();
+        delivered = outcome;
+    });
+
+    EXPECT(handle.waitFor(5000));
+    EXPECT(calls == 0);
+    for (int i = 0; i < 500 && queue.pending() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT(queue.drain() == 1);
+    EXPECT(calls == 1);
+    EXPECT(ranOn == caller);
+    EXPECT(delivered.result.success);
+    EXPECT(handle.attempts() >= 1);
+
+    DominoGame game(false, 8);
+    game.installPuzzle(delivered.puzzle);
+    EXPECT(game.getStateVersion() > 0);
+    EXPECT(game.getAvailableDominoes().size() == delivered.puzzle.solution.size());
+}
+
+void checkAsyncCancelledWhileQueued() {
+    AsyncGenerator generator(1);
+    GenerationHandle slow = generator.submit(slowRequest());
+    EXPECT(waitUntilRunning(slow, 5000));
+
+    GenerationHandle queued = generator.submit(GenerationRequest(8, false, Difficulty::EASY, 1000));
+    queued.cancel();
+    slow.cancel();
+    EXPECT(queued.waitFor(5000));
+    EXPECT(queued.get().result.cancelled);
+    EXPECT(!queued.get().puzzle.isValid());
+}
+
+void checkAsyncShutdownCancelsRunningJob() {
+    GenerationHandle handle;
+    Clock::time_point start;
+    {
+        AsyncGenerator generator(1);
+        handle = generator.submit(slowRequest());
+        EXPECT(waitUntilRunning(handle, 5000));
+        start = Clock::now();
+    }
+    EXPECT(elapsedMs(start) < 1000.0);
+    EXPECT(handle.isReady());
+}
+
+void checkAsyncReportsFailure() {
+    QueuedCompletions queue;
+    AsyncGenerator generator(1);
+
+    GenerationOutcome delivered;
+    delivered.result.success = true;
+    GenerationHandle handle = generator.submit(GenerationRequest(0, false, Difficulty::EASY, 1000), &queue,
+        [&](const GenerationOutcome& outcome) { delivered = outcome; });
+    EXPECT(handle.waitFor(5000));
+    for (int i = 0; i < 500 && queue.pending() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT(queue.drain() == 1);
+    EXPECT(!delivered.result.success);
+    EXPECT(!delivered.puzzle.isValid());
+    EXPECT(delivered.error == "Invalid grid size");
+    EXPECT(handle.get().error == delivered.error);
+}
+
+// --- RandomStream -----------------------------------------------------------------
+
+void checkRandomStreamMatchesReference() {
+    // Blackman and Vigna's reference xoshiro256** seeded through SplitMix64; three draws,
+    // a jump, three more
+    const uint64_t expected[2][6] = {
+        { 0x99ec5f36cb75f2b4ull, 0xbf6e1f784956452aull, 0x1a5f849d4933e6e0ull,
+          0x06c27b341aca7b26ull, 0x2d2d68024469b89eull, 0xfd4c3ae46ca64165ull },
+        { 0xb3f2af6d0fc710c5ull, 0x853b559647364ceaull, 0x92f89756082a4514ull,
+          0x4e6d496401657f6dull, 0xf770713745c5da5eull, 0xc55814dc11e24154ull },
+    };
+    for (uint64_t seed = 0; seed < 2; ++seed) {
+        RandomStream stream(seed);
+        for (int i = 0; i < 6; ++i) {
+            if (i == 3) stream.jump();
+            EXPECT(stream.next() == expected[seed][i]);
+        }
+    }
+}
+
+void checkRandomStreamSplitIsDeterministic() {
+    // A split hands out the parent's next draws and moves the parent on by one jump
+    RandomStream root(1234), copy(1234);
+    RandomStream first = root.split();
+    RandomStream second = root.split();
+    RandomStream expectFirst = copy;
+    copy.jump();
+    RandomStream expectSecond = copy;
+    copy.jump();
+    for (int i = 0; i < 100; ++i) {
+        EXPECT(first.next() == expectFirst.next());
+        EXPECT(second.next() == expectSecond.next());
+        EXPECT(root.next() == copy.next());
+    }
+
+    // Streams split from the same root agree no matter how much the others drew
+    RandomStream a(99), b(99);
+    RandomStream a1 = a.split(), b1 = b.split();
+    for (int i = 0; i < 1000; ++i) a1.next();
+    RandomStream a2 = a.split(), b2 = b.split();
+    (void)b1;
+    bool same = true, differs = false;
+    for (int i = 0; i < 100; ++i) {
+        uint64_t x = a2.next();
+        same = same && x == b2.next();
+        differs = differs || x != a1.next();
+    }
+    EXPECT(same);
+    EXPECT(differs);
+}
+
+void checkRandomStreamBoundedDraws() {
+    RandomStream stream(7);
+    const uint32_t bounds[] = { 1, 2, 3, 6, 1000, 0x80000001u, 0xFFFFFFFFu };
+    for (uint32_t bound : bounds) {
+        bool inRange = true;
+        for (int i = 0; i < 10000; ++i) {
+            inRange = inRange && stream.below(bound) < bound;
+        }
+        EXPECT(inRange);
+    }
+
+    // 60000 draws of a die: each face within 5% of its share (seeded, so not flaky)
+    int faces[6] = {};
+    for (int i = 0; i < 60000; ++i) ++faces[stream.below(6)];
+    for (int face : faces) EXPECT(face > 9500 && face < 10500);
+
+    std::vector<int> items(50), again;
+    for (int i = 0; i < 50; ++i) items[i] = i;
+    again = items;
+    RandomStream x(5), y(5);
+    x.shuffle(items);
+    y.shuffle(again);
+    EXPECT(items == again);
+    std::vector<int> sorted = items;
+    std::sort(sorted.begin(), sorted.end());
+    bool permutation = true;
+    for (int i = 0; i < 50; ++i) permutation = permutation && sorted[i] == i;
+    EXPECT(permutation);
+}
+
+void checkLazyPermutationWalks() {
+    const uint32_t count = 200;
+    LazyPermutation order;
+    order.resize(count);
+    RandomStream stream(11);
+
+    // Walks of every length draw distinct values, and a full walk draws each once
+    for (uint32_t length : { 0u, 1u, 7u, count, 50u, count }) {
+        order.begin();
+        std::vector<bool> seen(count, false);
+        bool distinct = true;
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < length; ++i) {
+            EXPECT(order.next(stream, value));
+            distinct = distinct && !seen[value];
+            seen[value] = true;
+        }
+        EXPECT(distinct);
+        EXPECT(order.drawnCount() == length);
+
+        std::vector<uint32_t> rest;
+        order.remaining(rest);
+        EXPECT(rest.size() == count - length);
+        bool complement = true;
+        for (uint32_t v : rest) complement = complement && !seen[v];
+        EXPECT(complement);
+        if (length == count) EXPECT(!order.next(stream, value));
+    }
+
+    // begin() puts the table back, so a used permutation walks like a fresh one
+    LazyPermutation fresh;
+    fresh.resize(count);
+    order.begin();
+    RandomStream x(3), y(3);
+    bool same = true;
+    uint32_t a = 0, b = 0;
+    while (order.next(x, a)) {
+        same = same && fresh.next(y, b) && a == b;
+    }
+    EXPECT(same);
+}
+
+// --- ClueSumTables ------------------------------------------------------------------
+
+uint32_t sums(std::initializer_list<int> values) {
+    uint32_t mask = 0;
+    for (int value : values) mask |= 1u << value;
+    return mask;
+}
+
+void checkClueSumPartitions() {
+    const ClueSumTables& tables = ClueSumTables::instance();
+
+    // Sets of distinct sums 1..18, at most `slots` of them, adding up to the clue
+    struct Known { int clue, slots, count; };
+    const Known known[] = {
+        { 1, 4, 1 }, { 3, 1, 1 }, { 3, 4, 2 }, { 6, 1, 1 }, { 6, 2, 3 }, { 6, 4, 4 }, { 10, 4, 10 },
+        { 19, 1, 0 }, { 19, 2, 9 }, { 40, 2, 0 }, { 40, 4, 139 }, { 66, 3, 0 }, { 66, 4, 1 }, { 66, 9, 1 },
+        { 0, 4, 0 }, { -1, 4, 0 }, { 67, 4, 0 }, { 6, 0, 0 },
+    };
+    for (const Known& entry : known) {
+        EXPECT(tables.partitionCount(entry.clue, entry.slots) == entry.count);
+    }
+    EXPECT(ClueSumTables::MAX_CLUE == 66);
+
+    EXPECT(tables.feasible(0, 0, 0));
+    EXPECT(tables.feasible(6, 2, sums({ 1, 5 })));
+    EXPECT(!tables.feasible(6, 2, sums({ 2, 3 })));
+    EXPECT(tables.feasible(6, 3, sums({ 1, 2, 3 })));
+    EXPECT(!tables.feasible(19, 1, ClueSumTables::ALL_SUMS));
+
+    uint32_t usable = 0, required = 0;
+    EXPECT(tables.partitionBounds(6, 4, sums({ 1, 2, 3, 4, 5 }), usable, required));
+    EXPECT(usable == sums({ 1, 2, 3, 4, 5 }) && required == 0);
+    EXPECT(tables.partitionBounds(7, 2, sums({ 1, 2, 6 }), usable, required));
+    EXPECT(usable == sums({ 1, 6 }) && required == sums({ 1, 6 }));
+    EXPECT(!tables.partitionBounds(7, 2, sums({ 2, 3 }), usable, required));
+    EXPECT(usable == 0 && required == 0);
+}
+
+// --- FeasibilityCheck ---------------------------------------------------------------
+
+CompactBoard boardWithPieces(int size, std::initializer_list<std::pair<int, int>> pieces) {
+    CompactBoard board;
+    board.reset(size);
+    for (const auto& piece : pieces) board.addPiece(piece.first, piece.second);
+    return board;
+}
+
+void checkFeasibilityReasons() {
+    // Three pieces claim 18 corner points with their halos; an open 3x3 board has 16
+    FeasibilityReport report = FeasibilityCheck::check(boardWithPieces(3, { { 0, 1 }, { 0, 2 }, { 1, 2 } }));
+    EXPECT(report.reason == Infeasibility::AREA);
+    EXPECT(report.needed == 18 && report.available == 16);
+
+    // On 4x4 the area fits (25 points), but digits 0-2 give each line one free pair:
+    // 8 line slots for the 9 the three pieces need
+    report = FeasibilityCheck::check(boardWithPieces(4, { { 0, 1 }, { 0, 2 }, { 1, 2 } }));
+    EXPECT(report.reason == Infeasibility::LINE_DIGITS);
+    EXPECT(report.needed == 9 && report.available == 8);
+
+    // Room and digits to spare, but sums 1 and 2 cannot make a 10
+    CompactBoard clued = boardWithPieces(6, { { 0, 1 }, { 0, 2 } });
+    clued.setClue(2, 3, 10);
+    report = FeasibilityCheck::check(clued);
+    EXPECT(report.reason == Infeasibility::CLUE_UNREACHABLE);
+    EXPECT(report.row == 2 && report.col == 3 && report.needed == 10);
+
+    // The same board with a clue of 3 passes every bound
+    clued.setClue(2, 3, 3);
+    EXPECT(FeasibilityCheck::check(clued).isFeasible());
+
+    // Pool rules come first
+    report = FeasibilityCheck::check(boardWithPieces(6, { { 0, 1 }, { 2, 2 } }));
+    EXPECT(report.reason == Infeasibility::DOUBLE_PIECE && report.piece == 1);
+    report = FeasibilityCheck::check(boardWithPieces(6, { { 0, 3 }, { 1, 2 } }));
+    EXPECT(report.reason == Infeasibility::DUPLICATE_SUMS && report.piece == 1);
+}
+
+// --- Generator ----------------------------------------------------------------
+
+Clock::time_point farDeadline() {
+    return Clock::now() + std::chrono::seconds(30);
+}
+
+void checkGeneratorAcceptsFirstPlacement() {
+    // A 2x2 board holds one piece, and every legal spot for it on the empty board is a solution
+    DominoGame tiny(false, 2);
+    GenerationResult result = tiny.generateNewGame(Difficulty::EASY, 1, farDeadline());
+    EXPECT(result.success);
+    EXPECT(!result.simplified);
+    EXPECT(result.attempts == 1);
+    EXPECT(tiny.getAvailableDominoes().size() == 1);
+    if (SearchStats::enabled()) {
+        EXPECT(result.search.maxDepth == 1);
+        EXPECT(result.search.backtracks == 0);
+    }
+
+    DominoGame game(false, 12);
+    result = game.generateNewGame(Difficulty::MEDIUM, 1, farDeadline());
+    EXPECT(result.success);
+    EXPECT(!result.simplified);
+    if (SearchStats::enabled()) {
+        EXPECT(result.search.maxDepth == static_cast<int>(game.getAvailableDominoes().size()));
+    }
+}
+
+// Free cells next to a solution piece that show no clue
+int hiddenClueCount(const GeneratedPuzzle& puzzle) {
+    int size = puzzle.gridSize;
+    std::vector<std::vector<bool>> covered(size, std::vector<bool>(size, false));
+    for (const Domino& domino : puzzle.solution) {
+        for (const Position& pos : domino.getOccupiedPositions()) {
+            covered[pos.row][pos.col] = true;
+        }
+    }
+
+    int hidden = 0;
+    for (int row = 0; row < size; ++row) {
+        for (int col = 0; col < size; ++col) {
+            if (covered[row][col] || puzzle.clues[row][col] > 0) continue;
+
+            bool nextToPiece = false;
+            for (int dr = -1; dr <= 1; ++dr) {
+                for (int dc = -1; dc <= 1; ++dc) {
+                    int r = row + dr, c = col + dc;
+                    if (r >= 0 && r < size && c >= 0 && c < size && covered[r][c]) nextToPiece = true;
+                }
+            }
+            if (nextToPiece) ++hidden;
+        }
+    }
+    return hidden;
+}
+
+void checkGeneratorGradesAndHidesClues() {
+    for (bool extended : { false, true }) {
+        DominoGame game(extended, 8);
+        GenerationResult result = game.generateNewGame(Difficulty::MEDIUM, 1, farDeadline());
+        EXPECT(result.success);
+        EXPECT(!result.simplified);
+        EXPECT(result.grade.solvable);
+        EXPECT(result.metTargets);
+        EXPECT(result.grade.tier == static_cast<int>(Difficulty::MEDIUM));
+        EXPECT(game.getPuzzleGrade().score == result.grade.score);
+        EXPECT(hiddenClueCount(game.exportPuzzle()) > 0);
+    }
+}
+
+bool samePuzzle(const GeneratedPuzzle& a, const GeneratedPuzzle& b) {
+    if (a.clues != b.clues || a.solution.size() != b.solution.size()) return false;
+    for (size_t i = 0; i < a.solution.size(); ++i) {
+        if (a.solution[i].getCanonicalForm() != b.solution[i].getCanonicalForm() ||
+            !(a.solution[i].getPosition() == b.solution[i].getPosition()) ||
+            a.solution[i].getOrientation() != b.solution[i].getOrientation()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void checkGeneratorSameSeedSamePuzzle() {
+    for (int size : { 6, 12 }) {
+        DominoGame first(true, size), second(true, size), other(true, size);
+        GenerationResult a = first.generateNewGame(Difficulty::HARD, 42, farDeadline());
+        // A game that generated before must not carry anything into the next puzzle
+        second.generateNewGame(Difficulty::EASY, 7, farDeadline());
+        GenerationResult b = second.generateNewGame(Difficulty::HARD, 42, farDeadline());
+        other.generateNewGame(Difficulty::HARD, 43, farDeadline());
+
+        EXPECT(a.success && !a.simplified);
+        EXPECT(b.success && !b.simplified);
+        EXPECT(a.nodes == b.nodes);
+        EXPECT(first.getPuzzleSeed() == 42);
+        EXPECT(samePuzzle(first.exportPuzzle(), second.exportPuzzle()));
+        EXPECT(!samePuzzle(first.exportPuzzle(), other.exportPuzzle()));
+        EXPECT(first.exportPuzzle().seeded);
+    }
+
+    // The worker pool deals the same puzzle for the same seed
+    AsyncGenerator generator(2);
+    GenerationRequest request(8, false, Difficulty::MEDIUM, 30000);
+    request.seed = 42;
+    GenerationHandle handle = generator.submit(request);
+    EXPECT(handle.waitFor(30000));
+    DominoGame direct(false, 8);
+    direct.generateNewGame(Difficulty::MEDIUM, 42, farDeadline());
+    EXPECT(samePuzzle(handle.get().puzzle, direct.exportPuzzle()));
+}
+
+// --- Saves ----------------------------------------------------------------------
+
+// A generated 8x8 game with one piece placed from a hint
+void startGame(DominoGame& game) {
+    game.generateNewGame(Difficulty::MEDIUM, 1, farDeadline());
+    Position first, second;
+    int value = 0;
+    game.getHint(first, second, value);
+    GeneratedPuzzle puzzle = game.exportPuzzle();
+    const Domino& piece = puzzle.solution.front();
+    game.placeDomino(piece, piece.getPosition(), piece.getOrientation());
+}
+
+bool sameBoard(const DominoGame& a, const DominoGame& b) {
+    if (a.getGrid() != b.getGrid() || a.getDominoGrid() != b.getDominoGrid() ||
+        a.getPlacedDominoes().size() != b.getPlacedDominoes().size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.getPlacedDominoes().size(); ++i) {
+        const Domino& x = a.getPlacedDominoes()[i];
+        const Domino& y = b.getPlacedDominoes()[i];
+        if (x.getCanonicalForm() != y.getCanonicalForm() || !(x.getPosition() == y.getPosition()) ||
+            x.getOrientation() != y.getOrientation()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The layout loadLegacyGame reads: native ints, the difficulty enum and a bool, then the pieces
+struct LegacySave {
+    std::vector<uint8_t> bytes;
+
+    template <typename T>
+    void put(const T& field) {
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(&field);
+        bytes.insert(bytes.end(), raw, raw + sizeof(field));
+    }
+
+    void putPiece(int v1, int v2, int row, int col, Orientation orient) {
+        put(v1);
+        put(v2);
+        put(row);
+        put(col);
+        put(orient);
+    }
+};
+
+bool writeFile(const char* name, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(name, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return file.good();
+}
+
+std::vector<uint8_t> readFile(const char* name) {
+    std::ifstream file(name, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void checkSaveRoundTrip() {
+    DominoGame game(false, 8);
+    startGame(game);
+    EXPECT(game.getPlacedDominoes().size() == 1);
+    EXPECT(game.getHintsUsed() == 1);
+
+    std::vector<uint8_t> save = game.serialize();
+    DominoGame restored(true, 4);
+    EXPECT(restored.deserialize(save.data(), save.size()));
+    EXPECT(restored.getGridSize() == 8);
+    EXPECT(sameBoard(game, restored));
+    EXPECT(restored.getHintsUsed() == game.getHintsUsed());
+    EXPECT(restored.getMovesCount() == game.getMovesCount());
+    EXPECT(restored.getDifficulty() == game.getDifficulty());
+    EXPECT(restored.getPuzzleSeed() == game.getPuzzleSeed());
+    EXPECT(restored.getPuzzleGrade().score == game.getPuzzleGrade().score);
+    EXPECT(restored.getAvailableDominoes().size() == game.getAvailableDominoes().size());
+    EXPECT(restored.serialize() == save);
+}
+
+void checkFailedLoadKeepsGame() {
+    DominoGame game(false, 8);
+    startGame(game);
+    std::vector<uint8_t> save = game.serialize();
+    uint64_t version = game.getStateVersion();
+    DominoGame before(false, 8);
+    EXPECT(before.deserialize(save.data(), save.size()));
+
+    // Damaged saves are refused before anything is touched
+    EXPECT(!game.deserialize(save.data(), save.size() - 1));
+    std::vector<uint8_t> flipped = save;
+    flipped.back() ^= 1;
+    EXPECT(!game.deserialize(flipped.data(), flipped.size()));
+
+    // A legacy save that parses, but whose second piece overlaps the first
+    LegacySave overlapping;
+    overlapping.put(6);
+    overlapping.put(Difficulty::HARD);
+    overlapping.put(false);
+    overlapping.put(2);
+    overlapping.put(7);
+    for (int cell = 0; cell < 36; ++cell) overlapping.put(0);
+    overlapping.put(static_cast<size_t>(2));
+    overlapping.putPiece(0, 1, 0, 0, Orientation::HORIZONTAL);
+    overlapping.putPiece(0, 2, 0, 1, Orientation::VERTICAL);
+    const char* path = "engine-selftest-legacy.sav";
+    EXPECT(writeFile(path, overlapping.bytes));
+    EXPECT(!game.loadGame(path, LoadMode::TRUSTED));
+
+    // Cut short inside the piece list
+    std::vector<uint8_t> truncated(overlapping.bytes.begin(), overlapping.bytes.end() - 3);
+    EXPECT(writeFile(path, truncated));
+    EXPECT(!game.loadGame(path));
+
+    EXPECT(game.getStateVersion() == version);
+    EXPECT(game.getGridSize() == 8);
+    EXPECT(sameBoard(game, before));
+    EXPECT(game.getHintsUsed() == 1);
+    EXPECT(game.getPuzzleSeed() == before.getPuzzleSeed());
+
+    // The same save with only the first piece loads, counters included
+    overlapping.bytes.resize(overlapping.bytes.size() - 2 * (4 * sizeof(int) + sizeof(Orientation)));
+    overlapping.bytes.resize(overlapping.bytes.size() - sizeof(size_t));
+    overlapping.put(static_cast<size_t>(1));
+    overlapping.putPiece(0, 1, 0, 0, Orientation::HORIZONTAL);
+    EXPECT(writeFile(path, overlapping.bytes));
+    EXPECT(game.loadGame(path));
+    EXPECT(game.getGridSize() == 6);
+    EXPECT(game.getDifficulty() == Difficulty::HARD);
+    EXPECT(game.getPlacedDominoes().size() == 1);
+    EXPECT(game.getHintsUsed() == 2);
+    EXPECT(game.getMovesCount() == 7);
+    std::remove(path);
+}
+
+struct SavedPiece { int v1, v2, row, col, vertical; };
+
+// A 4x4 save with no clues whose solution is exactly `pieces`, all of them placed,
+// laid out as serialize() writes it
+std::vector<uint8_t> finishedSave(std::initializer_list<SavedPiece> pieces) {
+    std::vector<uint8_t> buffer(16, 0);
+    BitWriter bits(buffer);
+    bits.write(4, 5);
+    bits.write(0, 2);
+    bits.write(0, 8);
+    bits.write(0, 32);
+    for (int cell = 0; cell < 16; ++cell) bits.write(0, 4);
+    for (int copy = 0; copy < 2; ++copy) {
+        bits.write(static_cast<uint32_t>(pieces.size()), 8);
+        for (const SavedPiece& piece : pieces) {
+            bits.write(static_cast<uint32_t>(piece.v1), 4);
+            bits.write(static_cast<uint32_t>(piece.v2), 4);
+            bits.write(static_cast<uint32_t>((piece.row * 4 + piece.col) * 2 + piece.vertical), 10);
+        }
+    }
+    bits.write(0, 2);
+    bits.write(0, 16);
+    bits.flush();
+
+    LittleEndian::put32(buffer.data(), 0x535A5044);
+    LittleEndian::put16(buffer.data() + 4, 1);
+    LittleEndian::put16(buffer.data() + 6, 2);
+    LittleEndian::put32(buffer.data() + 8, static_cast<uint32_t>(buffer.size() - 16));
+    LittleEndian::put32(buffer.data() + 12, Crc32::compute(buffer.data() + 16, buffer.size() - 16));
+    return buffer;
+}
+
+void checkWinCheckFollowsMoveRules() {
+    // Legal: no line repeats a digit among the pieces that touch it
+    std::vector<uint8_t> legal = finishedSave({ { 1, 2, 0, 0, 1 }, { 1, 3, 3, 2, 0 } });
+    // A vertical piece's second row holds a 1, and so does the piece beside it
+    std::vector<uint8_t> secondRow = finishedSave({ { 1, 2, 0, 0, 1 }, { 1, 3, 1, 2, 0 } });
+    // A horizontal piece's second column holds a 2, and so does the piece below it
+    std::vector<uint8_t> secondColumn = finishedSave({ { 1, 2, 0, 0, 0 }, { 2, 3, 2, 1, 1 } });
+
+    DominoGame game(false, 4);
+    EXPECT(game.deserialize(legal.data(), legal.size(), LoadMode::TRUSTED));
+    EXPECT(game.getPlacedDominoes().size() == 2);
+    EXPECT(game.validatePlacements());
+    EXPECT(game.isGameCompleted());
+
+    for (const std::vector<uint8_t>* save : { &secondRow, &secondColumn }) {
+        EXPECT(game.deserialize(save->data(), save->size(), LoadMode::TRUSTED));
+        EXPECT(game.getPlacedDominoes().size() == 2);
+        EXPECT(!game.validatePlacements());
+        EXPECT(!game.isGameCompleted());
+        EXPECT(!game.deserialize(save->data(), save->size()));
+    }
+}
+
+// --- Hints -----------------------------------------------------------------------------
+
+// Places solution piece `index` where the solution has it
+bool placeSolutionPiece(DominoGame& game, size_t index) {
+    GeneratedPuzzle puzzle = game.exportPuzzle();
+    const Domino& piece = puzzle.solution[index];
+    return game.placeDomino(piece, piece.getPosition(), piece.getOrientation());
+}
+
+bool waitFor(const std::function<bool()>& condition, int timeoutMs) {
+    Clock::time_point start = Clock::now();
+    while (!condition()) {
+        if (elapsedMs(start) > timeoutMs) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void checkStateListenersCoexist() {
+    DominoGame game(false, 8);
+    game.generateNewGame(Difficulty::MEDIUM, 1, farDeadline());
+    int heard = 0;
+    uint64_t lastVersion = 0;
+    int listener = game.addStateListener([&](uint64_t version) {
+        ++heard;
+        lastVersion = version;
+    });
+
+    HintSystem first(game);
+    {
+        HintSystem second(game);
+        EXPECT(placeSolutionPiece(game, 0));
+        EXPECT(heard == 1 && lastVersion == game.getStateVersion());
+        EXPECT(waitFor([&] { return first.isHintReady() && second.isHintReady(); }, 10000));
+    }
+
+    // Dropping one hint system leaves the others subscribed
+    EXPECT(placeSolutionPiece(game, 1));
+    EXPECT(heard == 2);
+    EXPECT(waitFor([&] { return first.isHintReady(); }, 10000));
+
+    game.removeStateListener(listener);
+    EXPECT(placeSolutionPiece(game, 2));
+    EXPECT(heard == 2);
+}
+
+void checkMoveCancelsPrecomputedHint() {
+    DominoGame game(false, 8);
+    game.generateNewGame(Difficulty::MEDIUM, 1, farDeadline());
+    uint64_t firstVersion = game.getStateVersion();
+
+    // The search for the first state runs until cancelled, then answers anyway
+    std::atomic<bool> started(false), sawCancel(false);
+    HintPrecomputer precomputer([&](const BoardSnapshot& snap, const CancellationToken& cancel) {
+        SolverHint hint;
+        hint.status = SolverHint::PLACEMENT;
+        hint.nodes = snap.version;
+        if (snap.version == firstVersion) {
+            started = true;
+            Clock::time_point start = Clock::now();
+            while (!cancel.isCancelled() && elapsedMs(start) < 10000) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            sawCancel = cancel.isCancelled();
+        }
+        return hint;
+    });
+    int listener = game.addStateListener([&](uint64_t) { precomputer.schedule(game.snapshot()); });
+    precomputer.schedule(game.snapshot());
+    EXPECT(waitFor([&] { return started.load(); }, 5000));
+
+    EXPECT(placeSolutionPiece(game, 0));
+    uint64_t secondVersion = game.getStateVersion();
+    EXPECT(waitFor([&] { return sawCancel.load(); }, 5000));
+
+    SolverHint hint;
+    EXPECT(waitFor([&] { return precomputer.tryGetResult(secondVersion, hint); }, 5000));
+    EXPECT(hint.nodes == secondVersion);
+    EXPECT(!precomputer.tryGetResult(firstVersion, hint));
+
+    // A result is only ever served for the state it was computed from
+    EXPECT(placeSolutionPiece(game, 1));
+    EXPECT(waitFor([&] { return precomputer.tryGetResult(game.getStateVersion(), hint); }, 5000));
+    EXPECT(!precomputer.tryGetResult(secondVersion, hint));
+    game.removeStateListener(listener);
+}
+
+// --- AutosaveJournal ----------------------------------------------------------------
+
+const char* const AUTOSAVE_PATH = "engine-selftest-auto.sav";
+const char* const JOURNAL_PATH = "engine-selftest-auto.sav.journal";
+const int64_t JOURNAL_HEADER_SIZE = 16;
+
+void removeAutosave() {
+    std::remove(AUTOSAVE_PATH);
+    std::remove(JOURNAL_PATH);
+}
+
+void checkJournalReplaysUpToTornEntry() {
+    removeAutosave();
+    DominoGame game(false, 8);
+    game.generateNewGame(Difficulty::MEDIUM, 1, farDeadline());
+    DominoGame beforeLast(false, 8);
+    {
+        AutosaveJournal journal(AUTOSAVE_PATH);
+        EXPECT(journal.attach(game));
+        EXPECT(journal.getSnapshotCount() == 1);
+        EXPECT(PlatformFile::size(JOURNAL_PATH) == JOURNAL_HEADER_SIZE);
+
+        EXPECT(placeSolutionPiece(game, 0));
+        EXPECT(placeSolutionPiece(game, 1));
+        EXPECT(game.removeDomino(game.exportPuzzle().solution[0].getPosition()));
+        std::vector<uint8_t> save = game.serialize();
+        EXPECT(beforeLast.deserialize(save.data(), save.size()));
+        EXPECT(placeSolutionPiece(game, 2));
+        EXPECT(journal.getEntriesSinceSnapshot() == 4);
+    }
+    int64_t written = JOURNAL_HEADER_SIZE + 4 * AutosaveJournal::ENTRY_SIZE;
+    EXPECT(PlatformFile::size(JOURNAL_PATH) == written);
+
+    // A crash while the last entry was being written
+    {
+        std::fstream file(JOURNAL_PATH, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(written - 3));
+        file.put('\x5A');
+    }
+
+    DominoGame restored(true, 4);
+    AutosaveJournal journal(AUTOSAVE_PATH);
+    EXPECT(journal.restore(restored));
+    EXPECT(sameBoard(restored, beforeLast));
+    EXPECT(restored.getMovesCount() == beforeLast.getMovesCount());
+    EXPECT(journal.getEntriesSinceSnapshot() == 3);
+    EXPECT(PlatformFile::size(JOURNAL_PATH) == JOURNAL_HEADER_SIZE + 3 * AutosaveJournal::ENTRY_SIZE);
+
+    // Attaching after a restore carries on with the same files
+    EXPECT(journal.attach(restored));
+    EXPECT(journal.getSnapshotCount() == 0);
+    EXPECT(placeSolutionPiece(restored, 2));
+    journal.detach();
+    EXPECT(PlatformFile::size(JOURNAL_PATH) == written);
+    removeAutosave();
+}
+
+void checkJournalCompactsAndSkipsStaleJournal() {
+    removeAutosave();
+    DominoGame game(false, 8);
+    game.generateNewGame(Difficulty::MEDIUM, 1, farDeadline());
+    DominoGame empty(false, 8);
+    std::vector<uint8_t> save = game.serialize();
+    EXPECT(empty.deserialize(save.data(), save.size()));
+
+    std::vector<uint8_t> stale;
+    {
+        AutosaveJournal journal(AUTOSAVE_PATH, AutosaveJournal::DEFAULT_SYNC_INTERVAL_MS, 3);
+        EXPECT(journal.attach(game));
+        EXPECT(placeSolutionPiece(game, 0));
+        journal.flush();
+        stale = readFile(JOURNAL_PATH);
+        EXPECT(stale.size() == static_cast<size_t>(JOURNAL_HEADER_SIZE + AutosaveJournal::ENTRY_SIZE));
+
+        // The third entry since the snapshot writes a new one instead
+        EXPECT(game.removeDomino(game.exportPuzzle().solution[0].getPosition()));
+        EXPECT(journal.getEntriesSinceSnapshot() == 2);
+        EXPECT(placeSolutionPiece(game, 1));
+        EXPECT(journal.getSnapshotCount() == 2);
+        EXPECT(journal.getEntriesSinceSnapshot() == 0);
+        EXPECT(PlatformFile::size(JOURNAL_PATH) == JOURNAL_HEADER_SIZE);
+
+        // So does replacing the game wholesale
+        EXPECT(game.removeDomino(game.exportPuzzle().solution[1].getPosition()));
+        EXPECT(journal.getEntriesSinceSnapshot() == 1);
+        EXPECT(game.deserialize(save.data(), save.size()));
+        EXPECT(journal.getSnapshotCount() == 3);
+        EXPECT(PlatformFile::size(JOURNAL_PATH) == JOURNAL_HEADER_SIZE);
+
+        // Back on the first snapshot's board, with one hint more
+        EXPECT(game.applyMove(MoveRecord(MoveRecord::HINT)));
+        EXPECT(journal.compact());
+    }
+
+    // The first journal's piece would still fit, but it extends an older snapshot
+    EXPECT(sameBoard(game, empty));
+    EXPECT(game.getHintsUsed() == empty.getHintsUsed() + 1);
+    EXPECT(writeFile(JOURNAL_PATH, stale));
+    DominoGame restored(false, 8);
+    AutosaveJournal journal(AUTOSAVE_PATH);
+    EXPECT(journal.restore(restored));
+    EXPECT(restored.getPlacedDominoes().empty());
+    EXPECT(sameBoard(restored, game));
+    EXPECT(restored.getHintsUsed() == game.getHintsUsed());
+    EXPECT(readFile(JOURNAL_PATH) == stale);
+
+    // ...and attaching replaces it with a journal for the snapshot on disk
+    EXPECT(journal.attach(restored));
+    EXPECT(journal.getSnapshotCount() == 1);
+    EXPECT(PlatformFile::size(JOURNAL_PATH) == JOURNAL_HEADER_SIZE);
+    journal.detach();
+    removeAutosave();
+}
+
+// --- PuzzleCache -------------------------------------------------------------------
+
+const char* const CACHE_DIRECTORY = "engine-selftest-cache";
+
+std::string cacheFile(const PuzzleKey& key) {
+    return std::string(CACHE_DIRECTORY) + "/puzzles-" + std::to_string(key.gridSize) + "-medium-std-v" +
+        std::to_string(DominoGame::GENERATOR_VERSION) + ".cache";
+}
+
+// Puzzles for 6x6 standard MEDIUM from seeds 1..count
+std::vector<GeneratedPuzzle> cachePuzzles(int count) {
+    std::vector<GeneratedPuzzle> puzzles;
+    for (int seed = 1; seed <= count; ++seed) {
+        DominoGame game(false, 6);
+        game.generateNewGame(Difficulty::MEDIUM, static_cast<uint64_t>(seed), farDeadline());
+        puzzles.push_back(game.exportPuzzle());
+    }
+    return puzzles;
+}
+
+void appendBytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+void checkCacheRecoversTornRecord() {
+    PuzzleKey key(6, Difficulty::MEDIUM, false);
+    std::string path = cacheFile(key);
+    size_t stride = PuzzleCache::recordSize(key);
+    std::vector<GeneratedPuzzle> puzzles = cachePuzzles(3);
+    PlatformFile::remove(path);
+    {
+        PuzzleCache cache(CACHE_DIRECTORY);
+        for (const GeneratedPuzzle& puzzle : puzzles) EXPECT(cache.store(puzzle));
+        EXPECT(cache.count(key) == 3);
+    }
+    int64_t complete = PlatformFile::size(path);
+    EXPECT(complete == static_cast<int64_t>(32 + 3 * stride));
+
+    // A crash part-way through the fourth append
+    appendBytes(path, std::vector<uint8_t>(stride / 2, 0xA5));
+    {
+        PuzzleCache cache(CACHE_DIRECTORY);
+        EXPECT(cache.count(key) == 3);
+        EXPECT(PlatformFile::size(path) == complete);
+
+        GeneratedPuzzle taken;
+        EXPECT(cache.take(key, taken));
+        EXPECT(samePuzzle(taken, puzzles[2]));
+        EXPECT(cache.store(puzzles[2]));
+        EXPECT(cache.count(key) == 3);
+    }
+
+    // A damaged middle record: everything from it on is cut off
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(32 + stride + stride / 2));
+        file.put('\x5A');
+    }
+    {
+        PuzzleCache cache(CACHE_DIRECTORY);
+        EXPECT(cache.count(key) == 1);
+        EXPECT(PlatformFile::size(path) == static_cast<int64_t>(32 + stride));
+        GeneratedPuzzle taken;
+        EXPECT(cache.take(key, taken));
+        EXPECT(samePuzzle(taken, puzzles[0]));
+        EXPECT(cache.count(key) == 0);
+    }
+    PlatformFile::remove(path);
+}
+
+void checkCacheRejectsPiecesOffGrid() {
+    PuzzleKey key(6, Difficulty::MEDIUM, false);
+    std::string path = cacheFile(key);
+    std::vector<GeneratedPuzzle> puzzles = cachePuzzles(1);
+    PlatformFile::remove(path);
+
+    // A vertical piece on the last row, or a horizontal one in the last column, is never stored
+    PuzzleCache cache(CACHE_DIRECTORY);
+    GeneratedPuzzle offGrid = puzzles[0];
+    offGrid.solution.front().place(Position(5, 0), Orientation::VERTICAL);
+    EXPECT(!cache.store(offGrid));
+    offGrid.solution.front().place(Position(0, 5), Orientation::HORIZONTAL);
+    EXPECT(!cache.store(offGrid));
+    EXPECT(cache.count(key) == 0);
+
+    // A record with an intact CRC whose first piece hangs off the bottom is refused on load
+    EXPECT(cache.store(puzzles[0]));
+    {
+        size_t stride = PuzzleCache::recordSize(key);
+        std::vector<uint8_t> record(stride);
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(32);
+        file.read(reinterpret_cast<char*>(record.data()), static_cast<std::streamsize>(stride));
+        LittleEndian::put16(&record[4 + 18 + 36 + 1], static_cast<uint16_t>(5 | (1 << 10)));
+        LittleEndian::put32(record.data(), Crc32::compute(record.data() + 4, stride - 4));
+        file.seekp(32);
+        file.write(reinterpret_cast<const char*>(record.data()), static_cast<std::streamsize>(stride));
+    }
+    GeneratedPuzzle taken;
+    EXPECT(!cache.take(key, taken));
+    EXPECT(cache.count(key) == 0);
+    PlatformFile::remove(path);
+}
+
+// --- PuzzleLibrary ------------------------------------------------------------------
+
+void checkLibraryRoundTrip() {
+    // Two sections: three 6x6 MEDIUM puzzles numbered 0-2, then two 8x8 HARD ones numbered 3-4
+    PuzzleKey small(6, Difficulty::MEDIUM, false), large(8, Difficulty::HARD, false);
+    std::vector<GeneratedPuzzle> puzzles;
+    for (int seed = 1; seed <= 2; ++seed) {
+        DominoGame game(false, 8);
+        game.generateNewGame(Difficulty::HARD, static_cast<uint64_t>(seed), farDeadline());
+        puzzles.push_back(game.exportPuzzle());
+    }
+    std::vector<GeneratedPuzzle> first = cachePuzzles(3);
+    puzzles.insert(puzzles.end(), first.begin(), first.end());
+
+    const char* path = "engine-selftest.dpz";
+    EXPECT(PuzzleLibrary::write(path, puzzles));
+    {
+        PuzzleLibrary library;
+        EXPECT(library.open(path));
+        EXPECT(library.size() == 5);
+        EXPECT(library.count(small) == 3 && library.firstOf(small) == 0);
+        EXPECT(library.count(large) == 2 && library.firstOf(large) == 3);
+
+        PuzzleKey key;
+        EXPECT(library.keyOf(2, key) && key.gridSize == 6);
+        EXPECT(library.keyOf(3, key) && key.gridSize == 8);
+        EXPECT(!library.keyOf(5, key));
+
+        GeneratedPuzzle loaded;
+        EXPECT(library.load(0, loaded));
+        EXPECT(samePuzzle(loaded, puzzles[2]));
+        EXPECT(loaded.difficulty == Difficulty::MEDIUM);
+        EXPECT(library.load(2, loaded));
+        EXPECT(samePuzzle(loaded, puzzles[4]));
+        EXPECT(library.load(3, loaded));
+        EXPECT(samePuzzle(loaded, puzzles[0]));
+        EXPECT(library.load(4, loaded));
+        EXPECT(samePuzzle(loaded, puzzles[1]));
+        EXPECT(loaded.grade.tier == puzzles[1].grade.tier);
+        EXPECT(loaded.grade.score == puzzles[1].grade.score);
+        EXPECT(!library.load(5, loaded));
+    }
+
+    // One flipped byte in the header or in the index, and the library is refused
+    std::vector<uint8_t> bytes = readFile(path);
+    const size_t flips[] = { 12, 32 + 4, 32 + 24 + 12 };
+    for (size_t offset : flips) {
+        std::vector<uint8_t> damaged = bytes;
+        damaged[offset] ^= 1;
+        EXPECT(writeFile(path, damaged));
+        PuzzleLibrary library;
+        EXPECT(!library.open(path));
+        EXPECT(!library.isOpen() && library.size() == 0);
+    }
+    std::remove(path);
+}
+
+// --- PuzzlePool ---------------------------------------------------------------------
+
+// Waits for a shelf's refills to finish and returns its counters
+PuzzlePoolStats settledStats(const PuzzlePool& pool, const PuzzleKey& key) {
+    Clock::time_point start = Clock::now();
+    PuzzlePoolStats stats = pool.getStats(key);
+    while (stats.inFlight > 0 && elapsedMs(start) < 30000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stats = pool.getStats(key);
+    }
+    return stats;
+}
+
+void checkPoolCountersAndWatermark() {
+    // 6x6 standard HARD reaches its tier from every seed tried
+    PuzzleKey key(6, Difficulty::HARD, false);
+    PuzzlePool pool(3, 2, 2, 30000);
+    pool.prefill(key);
+    PuzzlePoolStats stats = settledStats(pool, key);
+    EXPECT(stats.inFlight == 0);
+    EXPECT(stats.refills == 3);
+    EXPECT(stats.failedRefills == 0);
+    EXPECT(stats.ready == 3);
+    EXPECT(stats.hits == 0 && stats.misses == 0);
+
+    // Down to the watermark: nothing is queued
+    GeneratedPuzzle puzzle;
+    EXPECT(pool.take(key, puzzle));
+    EXPECT(puzzle.grade.tier == static_cast<int>(Difficulty::HARD));
+    stats = pool.getStats(key);
+    EXPECT(stats.hits == 1);
+    EXPECT(stats.ready == 2);
+    EXPECT(stats.inFlight == 0);
+
+    // Below it: the shelf is topped back up to capacity
+    EXPECT(pool.take(key, puzzle));
+    stats = settledStats(pool, key);
+    EXPECT(stats.refills == 5);
+    EXPECT(stats.failedRefills == 0);
+    EXPECT(stats.ready == 3);
+    EXPECT(stats.hits == 2);
+
+    // A key never prefilled misses, and the miss starts filling it
+    PuzzleKey cold(6, Difficulty::HARD, true);
+    EXPECT(!pool.take(cold, puzzle));
+    stats = settledStats(pool, cold);
+    EXPECT(stats.misses == 1);
+    EXPECT(stats.refills + stats.failedRefills == 3);
+    EXPECT(pool.getStats().hits == 2);
+    EXPECT(pool.getStats().misses == 1);
+}
+
+void checkPoolDropsOffTargetPuzzles() {
+    // A 2x2 board holds one piece and never grades above EASY
+    PuzzleKey key(2, Difficulty::MEDIUM, false);
+    PuzzlePool pool(2, 1, 1, 30000);
+    pool.prefill(key);
+    PuzzlePoolStats stats = settledStats(pool, key);
+    EXPECT(stats.refills == 0);
+    EXPECT(stats.failedRefills == 2);
+    EXPECT(stats.ready == 0);
+
+    GeneratedPuzzle puzzle;
+    EXPECT(!pool.take(key, puzzle));
+    DominoGame game(false, 2);
+    EXPECT(!pool.startGame(game, Difficulty::MEDIUM));
+    EXPECT(game.getAvailableDominoes().size() == 1);
+    settledStats(pool, key);
+}
+
+// --- TraceRecorder ------------------------------------------------------------------
+
+const char* const TRACE_PATH = "engine-selftest-trace.json";
+
+struct TraceLine {
+    std::string name;
+    std::string phase;
+    int tid;
+    int64_t ts;
+};
+
+// The quoted text, or the number, that follows `key` in a trace line; empty or -1 if absent
+std::string quotedAfter(const std::string& text, const char* key) {
+    size_t at = text.find(key);
+    if (at == std::string::npos) return std::string();
+    at += std::strlen(key);
+    return text.substr(at, text.find('"', at) - at);
+}
+
+int64_t numberAfter(const std::string& text, const char* key) {
+    size_t at = text.find(key);
+    return at == std::string::npos ? -1 : std::atoll(text.c_str() + at + std::strlen(key));
+}
+
+// The events of a flushed trace, one per line as flush() writes them; a metadata
+// line is named after the track it labels
+std::vector<TraceLine> readTrace(const char* path, bool& wellFormed) {
+    std::ifstream file(path);
+    std::string text;
+    std::vector<TraceLine> lines;
+    wellFormed = std::getline(file, text) && text == "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    while (std::getline(file, text) && text != "]}") {
+        TraceLine line;
+        line.phase = quotedAfter(text, "\"ph\": \"");
+        line.name = quotedAfter(text, line.phase == "M" ? "\"args\": {\"name\": \"" : "{\"name\": \"");
+        line.tid = static_cast<int>(numberAfter(text, "\"tid\": "));
+        line.ts = numberAfter(text, "\"ts\": ");
+        wellFormed = wellFormed && !line.phase.empty() && !line.name.empty() && line.tid > 0;
+        lines.push_back(line);
+    }
+    wellFormed = wellFormed && text == "]}";
+    return lines;
+}
+
+void checkTraceTracksPerThread() {
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.start();
+    EXPECT(recorder.flush(TRACE_PATH));
+
+    DominoGame game(false, 6);
+    std::thread first([&] {
+        recorder.setThreadName("selftest-first");
+        for (int i = 0; i < 3; ++i) {
+            TRACE_SPAN("selftest-span");
+        }
+        game.serialize();
+    });
+    first.join();
+    std::thread second([&] {
+        recorder.setThreadName("selftest-second");
+        TRACE_SPAN("selftest-span");
+    });
+    second.join();
+    recorder.stop();
+    {
+        TRACE_SPAN("selftest-while-off");
+    }
+    EXPECT(recorder.flush(TRACE_PATH));
+
+    bool wellFormed = false;
+    std::vector<TraceLine> lines = readTrace(TRACE_PATH, wellFormed);
+    EXPECT(wellFormed);
+    int firstTid = 0, secondTid = 0, tracks = 0;
+    for (const TraceLine& line : lines) {
+        if (line.phase != "M") continue;
+        ++tracks;
+        if (line.name == "selftest-first") firstTid = line.tid;
+        if (line.name == "selftest-second") secondTid = line.tid;
+    }
+    EXPECT(tracks == 2);
+    EXPECT(firstTid > 0 && secondTid > 0 && firstTid != secondTid);
+
+    int spans[2] = {}, serialized = 0, others = 0;
+    for (const TraceLine& line : lines) {
+        if (line.phase == "M") continue;
+        if (line.phase == "X" && line.name == "selftest-span" && line.tid == firstTid) ++spans[0];
+        else if (line.phase == "X" && line.name == "selftest-span" && line.tid == secondTid) ++spans[1];
+        else if (line.phase == "X" && line.name == "serialize" && line.tid == firstTid) ++serialized;
+        else ++others;
+    }
+    EXPECT(spans[0] == 3 && spans[1] == 1);
+    EXPECT(serialized == 1);
+    EXPECT(others == 0);
+
+    // A flush drains: the next one holds only the track names
+    EXPECT(recorder.flush(TRACE_PATH));
+    lines = readTrace(TRACE_PATH, wellFormed);
+    EXPECT(wellFormed);
+    EXPECT(lines.size() == 2);
+    std::remove(TRACE_PATH);
+}
+
+void checkTraceFullBufferDrops() {
+    TraceRecorder& recorder = TraceRecorder::instance();
+    uint64_t droppedBefore = recorder.droppedEvents();
+    const int extra = 10;
+    std::thread writer([&] {
+        recorder.setThreadName("selftest-full");
+        for (int i = 0; i < TraceBuffer::CAPACITY + extra; ++i) {
+            recorder.record("selftest-event", i, 1);
+        }
+    });
+    writer.join();
+    EXPECT(recorder.droppedEvents() == droppedBefore + extra);
+
+    // The first CAPACITY events survive; the ones that did not fit are the ones lost
+    EXPECT(recorder.flush(TRACE_PATH));
+    bool wellFormed = false;
+    std::vector<TraceLine> lines = readTrace(TRACE_PATH, wellFormed);
+    EXPECT(wellFormed);
+    int events = 0;
+    int64_t expectedTs = 0;
+    bool inOrder = true;
+    for (const TraceLine& line : lines) {
+        if (line.phase != "X") continue;
+        inOrder = inOrder && line.ts == expectedTs++;
+        ++events;
+    }
+    EXPECT(events == TraceBuffer::CAPACITY);
+    EXPECT(inOrder);
+    std::remove(TRACE_PATH);
+}
+
+// --- Allocations -------------------------------------------------------------------
+
+// Only measures in a build with -DDOMINO_ALLOCATION_TRACKING=1
+void checkZeroAllocationOperations() {
+    if (!AllocationTracker::enabled()) {
+        std::printf("  skipped: built without DOMINO_ALLOCATION_TRACKING\n");
+        return;
+    }
+
+    DominoGame game(true, 12);
+    game.generateNewGame(Difficulty::MEDIUM, 1, farDeadline());
+    AllocationTracker::reset();
+    std::vector<Domino> pieces = game.getAvailableDominoes();
+    for (const Domino& piece : pieces) {
+        for (int row = 0; row < 12; ++row) {
+            for (int col = 0; col < 12; ++col) {
+                if (game.placeDomino(piece, Position(row, col), Orientation::VERTICAL)) {
+                    game.removeDomino(Position(row, col));
+                }
+            }
+        }
+    }
+
+    uint64_t checks = 0;
+    AllocationTracker::forEach([&](const AllocationCounter& counter) {
+        if (std::strcmp(counter.name, "canPlaceDomino") == 0) checks = counter.calls.load();
+    });
+    EXPECT(checks > 0);
+    EXPECT(AllocationTracker::totalViolations() == 0);
+
+    // The hooks must see every kind of allocation, over-aligned ones included
+    struct alignas(64) Line { char bytes[64]; };
+    {
+        ZERO_ALLOCATION_SCOPE("selftest-allocations");
+        delete new int(1);
+        delete[] new char[16];
+#ifdef __cpp_aligned_new
+        delete new Line();
+        delete[] new Line[2];
+#endif
+    }
+    uint64_t expected = 2;
+#ifdef __cpp_aligned_new
+    expected += 2;
+#endif
+    EXPECT(AllocationTracker::totalViolations() == expected);
+    AllocationTracker::reset();
+}
+
+struct Check {
+    const char* name;
+    void (*run)();
+};
+
+const Check CHECKS[] = {
+    { "async-completion-on-draining-thread", checkAsyncCompletionRunsOnDrainingThread },
+    { "async-cancel-queued", checkAsyncCancelledWhileQueued },
+    { "async-shutdown-cancels-running", checkAsyncShutdownCancelsRunningJob },
+    { "async-reports-failure", checkAsyncReportsFailure },
+    { "random-stream-matches-reference", checkRandomStreamMatchesReference },
+    { "random-stream-split-is-deterministic", checkRandomStreamSplitIsDeterministic },
+    { "random-stream-bounded-draws", checkRandomStreamBoundedDraws },
+    { "lazy-permutation-walks", checkLazyPermutationWalks },
+    { "clue-sum-partitions", checkClueSumPartitions },
+    { "feasibility-reasons", checkFeasibilityReasons },
+    { "generator-accepts-first-placement", checkGeneratorAcceptsFirstPlacement },
+    { "generator-grades-and-hides-clues", checkGeneratorGradesAndHidesClues },
+    { "generator-same-seed-same-puzzle", checkGeneratorSameSeedSamePuzzle },
+    { "save-round-trip", checkSaveRoundTrip },
+    { "failed-load-keeps-game", checkFailedLoadKeepsGame },
+    { "win-check-follows-move-rules", checkWinCheckFollowsMoveRules },
+    { "state-listeners-coexist", checkStateListenersCoexist },
+    { "move-cancels-precomputed-hint", checkMoveCancelsPrecomputedHint },
+    { "journal-replays-up-to-torn-entry", checkJournalReplaysUpToTornEntry },
+    { "journal-compacts-and-skips-stale-journal", checkJournalCompactsAndSkipsStaleJournal },
+    { "cache-recovers-torn-record", checkCacheRecoversTornRecord },
+    { "cache-rejects-pieces-off-grid", checkCacheRejectsPiecesOffGrid },
+    { "library-round-trip", checkLibraryRoundTrip },
+    { "pool-counters-and-watermark", checkPoolCountersAndWatermark },
+    { "pool-drops-off-target-puzzles", checkPoolDropsOffTargetPuzzles },
+    { "trace-tracks-per-thread", checkTraceTracksPerThread },
+    { "trace-full-buffer-drops", checkTraceFullBufferDrops },
+    { "zero-allocation-operations", checkZeroAllocationOperations },
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    int run = 0, failed = 0;
+    for (const Check& check : CHECKS) {
+        if (!std::strstr(check.name, filter)) continue;
+
+        int before = failures;
+        std::printf("%s\n", check.name);
+        check.run();
+        ++run;
+        if (failures != before) ++failed;
+    }
+
+    std::printf("%d checks, %d failed\n", run, failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Build with DOMINO_TRACE set to 0 to compile every TRACE_SPAN out
+#ifndef DOMINO_TRACE
+#define DOMINO_TRACE 1
+#endif
+
+struct TraceEvent {
+    const char* name;           // string literal; only the pointer is kept
+    int64_t startMicros;        // since the recorder's epoch
+    int64_t durationMicros;
+};
+
+// Events of one thread. Only the owning thread appends and only TraceRecorder::flush
+// drains, so head and tail are the whole synchronisation. A full buffer drops new
+// events rather than overwrite ones a flush may be reading.
+class TraceBuffer {
+public:
+    static const int CAPACITY = 4096;   // power of two
+
+private:
+    TraceEvent events[CAPACITY];
+    std::atomic<uint64_t> head;         // next slot to write; owner thread
+    std::atomic<uint64_t> tail;         // next slot to drain; flushing thread
+    std::atomic<uint64_t> dropped;
+
+public:
+    const int threadId;
+    std::string threadName;             // guarded by the recorder's mutex
+
+    explicit TraceBuffer(int id) : head(0), tail(0), dropped(0), threadId(id) {}
+
+    void push(const TraceEvent& event) {
+        uint64_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) >= static_cast<uint64_t>(CAPACITY)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[position & (CAPACITY - 1)] = event;
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    template <typename Visit>
+    void drain(Visit visit) {
+        uint64_t position = tail.load(std::memory_order_relaxed);
+        uint64_t end = head.load(std::memory_order_acquire);
+        for (; position < end; ++position) {
+            visit(events[position & (CAPACITY - 1)]);
+        }
+        tail.store(end, std::memory_order_release);
+    }
+
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+// Process-wide collector for TRACE_SPAN. Off until start(); while off a span costs
+// one relaxed load. flush() writes everything recorded since the last flush as a
+// Chrome trace-event file (chrome://tracing, ui.perfetto.dev), one track per thread.
+class TraceRecorder {
+private:
+    std::atomic<bool> enabled;
+    const std::chrono::steady_clock::time_point epoch;
+    mutable std::mutex mutex;           // buffer registration, thread names and flushing
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+    TraceRecorder() : enabled(false), epoch(std::chrono::steady_clock::now()) {}
+
+public:
+    static TraceRecorder& instance() {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    void start() { enabled.store(true, std::memory_order_relaxed); }
+    void stop() { enabled.store(false, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    int64_t nowMicros() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void record(const char* name, int64_t startMicros, int64_t durationMicros) {
+        TraceEvent event = { name, startMicros, durationMicros };
+        localBuffer().push(event);
+    }
+
+    // Labels the calling thread's track; cheap enough to call when tracing is off
+    void setThreadName(const std::string& name) {
+        pendingThreadName() = name;
+        TraceBuffer* buffer = localBufferSlot();
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffer->threadName = name;
+        }
+    }
+
+    uint64_t droppedEvents() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t total = 0;
+        for (const auto& buffer : buffers) total += buffer->droppedCount();
+        return total;
+    }
+
+    // Drains every thread's buffer into a trace-event JSON file
+    bool flush(const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        bool first = true;
+        for (const auto& buffer : buffers) {
+            if (!buffer->threadName.empty()) {
+                out << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+                    << buffer->threadId << ", \"args\": {\"name\": \"" << escaped(buffer->threadName.c_str()) << "\"}}";
+                first = false;
+            }
+            buffer->drain([&](const TraceEvent& event) {
+                out << (first ? "\n" : ",\n") << "{\"name\": \"" << escaped(event.name)
+                    << "\", \"cat\": \"engine\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->threadId
+                    << ", \"ts\": " << event.startMicros << ", \"dur\": " << event.durationMicros << "}";
+                first = false;
+            });
+        }
+        out << "\n]}\n";
+        return out.good();
+    }
+
+private:
+    static TraceBuffer*& localBufferSlot() {
+        static thread_local TraceBuffer* buffer = nullptr;
+        return buffer;
+    }
+
+    static std::string& pendingThreadName() {
+        static thread_local std::string name;
+        return name;
+    }
+
+    TraceBuffer& localBuffer() {
+        TraceBuffer*& buffer = localBufferSlot();
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.emplace_back(new TraceBuffer(static_cast<int>(buffers.size()) + 1));
+            buffer = buffers.back().get();
+            buffer->threadName = pendingThreadName();
+        }
+        return *buffer;
+    }
+
+    static std::string escaped(const char* text) {
+        std::string result;
+        for (; *text; ++text) {
+            if (*text == '"' || *text == '\\') result += '\\';
+            if (static_cast<unsigned char>(*text) >= 0x20) result += *text;
+        }
+        return result;
+    }
+};
+
+// Times the enclosing scope as one complete event while the recorder is on
+class TraceSpan {
+private:
+    const char* name;
+    int64_t startMicros;
+
+public:
+    explicit TraceSpan(const char* spanName) : name(spanName), startMicros(-1) {
+        TraceRecorder& recorder = TraceRecorder::instance();
+        if (recorder.isEnabled()) {
+            startMicros = recorder.nowMicros();
+        }
+    }
+
+    ~TraceSpan() {
+        if (startMicros >= 0) {
+            TraceRecorder& recorder = TraceRecorder::instance();
+            recorder.record(name, startMicros, recorder.nowMicros() - startMicros);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#if DOMINO_TRACE
+#define TRACE_SPAN_JOIN2(a, b) a##b
+#define TRACE_SPAN_JOIN(a, b) TRACE_SPAN_JOIN2(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_SPAN_JOIN(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif